@@ -0,0 +1,518 @@
+/* bench.cpp - Benchmark suite with roofline and baseline comparison */
+/* by ValKmjolnir 2026/10/17 */
+
+#include "matrix.hpp"
+#include "word2vec.hpp"
+
+#include <omp.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using clk = std::chrono::steady_clock;
+
+struct bench_options {
+    std::string json_path;
+    std::string baseline_path;
+    std::string filter;
+    std::vector<int> threads;
+    double tolerance = 0.10;  // slowdown of the median that counts as a regression
+    double min_time = 0.2;    // seconds of timed repetitions per case
+    size_t warmup = 2;
+    size_t min_reps = 5;
+    size_t max_reps = 200;
+    bool quick = false;
+};
+
+struct bench_result {
+    std::string name;
+    std::string shape;
+    int threads;
+    size_t reps;
+    double median;
+    double p10;
+    double p90;
+    double gflops;
+    double gbs;
+    double roofline;       // attained fraction of the roofline bound, 0 if none
+    double items_per_s;    // words/s etc. for cases counted in items
+};
+
+// Peak FMA throughput and triad bandwidth for a thread count, the two
+// roofs every case is compared against.
+struct roofline {
+    double peak_gflops;
+    double bandwidth_gbs;
+
+    static double measure_peak(int threads) {
+        using V = simd_reg<float>;
+        constexpr size_t ACC = 8;
+        const size_t iters = 1 << 22;
+        const auto begin = clk::now();
+        #pragma omp parallel num_threads(threads)
+        {
+            typename V::reg acc[ACC];
+            for (size_t a = 0; a < ACC; ++a)
+                acc[a] = V::broadcast(static_cast<float>(a));
+            const auto x = V::broadcast(0.999999f);
+            const auto y = V::broadcast(1e-7f);
+            for (size_t i = 0; i < iters; ++i) {
+                #pragma GCC unroll 8
+                for (size_t a = 0; a < ACC; ++a)
+                    acc[a] = V::fmadd(acc[a], x, y);
+            }
+            float out[V::width];
+            float total = 0;
+            for (size_t a = 0; a < ACC; ++a) {
+                V::storeu(out, acc[a]);
+                total += out[0];
+            }
+            volatile float sink = total;
+            (void)sink;
+        }
+        const double t = std::chrono::duration<double>(clk::now() - begin).count();
+        return 2.0 * threads * iters * ACC * V::width / t * 1e-9;
+    }
+
+    static double measure_bandwidth(int threads) {
+        const size_t n = static_cast<size_t>(1) << 24;
+        std::vector<float> a(n), b(n, 1.0f), c(n, 2.0f);
+        double best = 0;
+        for (int rep = 0; rep < 5; ++rep) {
+            const auto begin = clk::now();
+            #pragma omp parallel for simd num_threads(threads) schedule(static)
+            for (size_t i = 0; i < n; ++i)
+                a[i] = b[i] + 3.0f * c[i];
+            const double t = std::chrono::duration<double>(clk::now() - begin).count();
+            best = std::max(best, 3.0 * n * sizeof(float) / t * 1e-9);
+        }
+        volatile float sink = a[n / 2];
+        (void)sink;
+        return best;
+    }
+
+    static roofline measure(int threads) {
+        return {measure_peak(threads), measure_bandwidth(threads)};
+    }
+
+    // fraction of min(peak, intensity * bandwidth) attained
+    double fraction(double flops, double bytes, double seconds) const {
+        if (flops > 0) {
+            const double bound = bytes > 0 ? std::min(peak_gflops, flops / bytes * bandwidth_gbs) : peak_gflops;
+            return flops / seconds * 1e-9 / bound;
+        }
+        return bytes > 0 ? bytes / seconds * 1e-9 / bandwidth_gbs : 0;
+    }
+};
+
+class bench_runner {
+private:
+    const bench_options& opt;
+    std::map<int, roofline> roofs;
+    std::vector<bench_result> results;
+
+    static double percentile(const std::vector<double>& sorted, double p) {
+        const double pos = p * (sorted.size() - 1);
+        const size_t lo = static_cast<size_t>(pos);
+        const size_t hi = std::min(lo + 1, sorted.size() - 1);
+        return sorted[lo] + (sorted[hi] - sorted[lo]) * (pos - lo);
+    }
+
+public:
+    explicit bench_runner(const bench_options& o): opt(o) {
+        for (int t : opt.threads) {
+            roofs[t] = roofline::measure(t);
+        }
+    }
+
+    const std::vector<bench_result>& get_results() const { return results; }
+    const std::map<int, roofline>& get_roofs() const { return roofs; }
+
+    // Times f at every thread count of the sweep. flops and bytes are the
+    // work and the minimum memory traffic of one call, items is an extra
+    // count to report per second (0 for none).
+    void run(const std::string& name, const std::string& shape, double flops, double bytes,
+             const std::function<void()>& f, double items = 0) {
+        if (!opt.filter.empty() && (name + " " + shape).find(opt.filter) == std::string::npos) {
+            return;
+        }
+        const int saved = omp_get_max_threads();
+        for (int t : opt.threads) {
+            omp_set_num_threads(t);
+            for (size_t w = 0; w < opt.warmup; ++w)
+                f();
+
+            std::vector<double> times;
+            double total = 0;
+            while (times.size() < opt.min_reps || (total < opt.min_time && times.size() < opt.max_reps)) {
+                const auto begin = clk::now();
+                f();
+                times.push_back(std::chrono::duration<double>(clk::now() - begin).count());
+                total += times.back();
+            }
+            std::sort(times.begin(), times.end());
+
+            bench_result r;
+            r.name = name;
+            r.shape = shape;
+            r.threads = t;
+            r.reps = times.size();
+            r.median = percentile(times, 0.5);
+            r.p10 = percentile(times, 0.1);
+            r.p90 = percentile(times, 0.9);
+            r.gflops = flops / r.median * 1e-9;
+            r.gbs = bytes / r.median * 1e-9;
+            r.roofline = roofs[t].fraction(flops, bytes, r.median);
+            r.items_per_s = items / r.median;
+            results.push_back(r);
+
+            std::cout << std::left << std::setw(14) << name << std::setw(18) << shape
+                      << std::right << std::setw(4) << t
+                      << std::fixed << std::setprecision(3)
+                      << std::setw(11) << r.median * 1e3
+                      << std::setw(11) << r.p10 * 1e3
+                      << std::setw(11) << r.p90 * 1e3
+                      << std::setprecision(2)
+                      << std::setw(10) << r.gflops
+                      << std::setw(10) << r.gbs
+                      << std::setw(8) << r.roofline * 100 << "%";
+            if (items > 0) {
+                std::cout << "  " << std::setprecision(0) << r.items_per_s << " items/s";
+            }
+            std::cout << std::defaultfloat << std::endl;
+        }
+        omp_set_num_threads(saved);
+    }
+};
+
+volatile double bench_sink = 0;
+
+std::string shape_of(size_t a, size_t b) {
+    return std::to_string(a) + "x" + std::to_string(b);
+}
+
+std::string shape_of(size_t a, size_t b, size_t c) {
+    return shape_of(a, b) + "x" + std::to_string(c);
+}
+
+void bench_gemm(bench_runner& bench, bool quick) {
+    std::vector<size_t> sizes = {256, 512, 1024, 2048};
+    if (quick) {
+        sizes = {256, 1024};
+    }
+    for (size_t n : sizes) {
+        matrix<float> A(n, n), B(n, n), C(n, n);
+        A.random_init(1);
+        B.random_init(2);
+        bench.run("gemm", shape_of(n, n, n), 2.0 * n * n * n, 3.0 * n * n * sizeof(float),
+                  [&] { C.gemm(A, B); bench_sink = C[0][0]; });
+    }
+
+    // tall-skinny (one layer of a batch) and matrix-vector
+    const size_t m = 4096, k = 1024, n = 64;
+    matrix<float> A(m, k), B(k, n), C(m, n), x(k, 1), y(m, 1);
+    A.random_init(3);
+    B.random_init(4);
+    x.random_init(5);
+    bench.run("gemm", shape_of(m, n, k), 2.0 * m * n * k, (m * k + k * n + m * n) * sizeof(float),
+              [&] { C.gemm(A, B); bench_sink = C[0][0]; });
+    bench.run("gemv", shape_of(m, 1, k), 2.0 * m * k, (m * k + k + m) * sizeof(float),
+              [&] { y.gemm(A, x); bench_sink = y[0][0]; });
+}
+
+void bench_transpose(bench_runner& bench, bool quick) {
+    const size_t n = quick ? 2048 : 4096;
+    matrix<float> A(n, n);
+    A.random_init(6);
+    bench.run("transpose", shape_of(n, n), 0, 2.0 * n * n * sizeof(float),
+              [&] { matrix<float> T = A.transpose(); bench_sink = T[0][1]; });
+    bench.run("transpose_ip", shape_of(n, n), 0, 2.0 * n * n * sizeof(float),
+              [&] { A.transpose_inplace(); bench_sink = A[0][1]; });
+}
+
+void bench_elementwise(bench_runner& bench, bool quick) {
+    const size_t rows = quick ? 1024 : 4096, cols = 1024;
+    const double n = static_cast<double>(rows) * cols;
+    matrix<float> a(rows, cols), b(rows, cols), c(rows, cols), bias(1, cols);
+    a.random_init(7);
+    b.random_init(8);
+    bias.random_init(9);
+
+    bench.run("add", shape_of(rows, cols), n, 3 * n * sizeof(float),
+              [&] { c = a + b; bench_sink = c[0][0]; });
+    bench.run("axpy_fused", shape_of(rows, cols), 2 * n, 3 * n * sizeof(float),
+              [&] { c = a * 2.0f + b; bench_sink = c[0][0]; });
+    bench.run("add_row", shape_of(rows, cols), n, 2 * n * sizeof(float),
+              [&] { c = a.add_row(bias); bench_sink = c[0][0]; });
+    bench.run("relu", shape_of(rows, cols), 0, 2 * n * sizeof(float),
+              [&] { c = a.relu(); bench_sink = c[0][0]; });
+
+    // the default exact mode, then the vectorized approximations
+    const math_mode mode = math_config::mode();
+    for (math_mode m : {math_mode::exact, math_mode::fast}) {
+        math_config::set_mode(m);
+        const std::string suffix = m == math_mode::fast ? "" : "_exact";
+        bench.run("sigmoid" + suffix, shape_of(rows, cols), 0, 2 * n * sizeof(float),
+                  [&] { c = a.sigmoid(); bench_sink = c[0][0]; });
+        bench.run("tanh" + suffix, shape_of(rows, cols), 0, 2 * n * sizeof(float),
+                  [&] { c = a.tanh(); bench_sink = c[0][0]; });
+        bench.run("softmax" + suffix, shape_of(rows, cols), 0, 2 * n * sizeof(float),
+                  [&] { c = a.softmax(); bench_sink = c[0][0]; });
+    }
+    math_config::set_mode(mode);
+}
+
+void bench_reductions(bench_runner& bench, bool quick) {
+    const size_t rows = quick ? 1024 : 4096, cols = 1024;
+    const double n = static_cast<double>(rows) * cols;
+    matrix<float> a(rows, cols), out(1, cols);
+    a.random_init(10);
+
+    bench.run("sum", shape_of(rows, cols), n, n * sizeof(float),
+              [&] { bench_sink = a.sum(); });
+    bench.run("sum_expr", shape_of(rows, cols), 2 * n, n * sizeof(float),
+              [&] { bench_sink = a.hadamard(a).sum(); });
+    bench.run("sum_rows", shape_of(rows, cols), n, n * sizeof(float),
+              [&] { out = a.sum(reduce_axis::rows); bench_sink = out[0][0]; });
+    bench.run("max_cols", shape_of(rows, cols), n, n * sizeof(float),
+              [&] { matrix<float> m = a.max(reduce_axis::cols); bench_sink = m[0][0]; });
+    bench.run("l2_normalize", shape_of(rows, cols), 3 * n, 3 * n * sizeof(float),
+              [&] { matrix<float> m = a.l2_normalize(); bench_sink = m[0][0]; });
+}
+
+// A synthetic corpus with a Zipf-like word distribution, words are spelled
+// in letters because the tokenizer drops everything else.
+std::string bench_corpus(size_t tokens, size_t vocab) {
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<double> u(0, 1);
+    std::string text;
+    for (size_t i = 0; i < tokens; ++i) {
+        size_t id = static_cast<size_t>(std::pow(static_cast<double>(vocab), u(rng))) - 1;
+        std::string word = "w";
+        do {
+            word += static_cast<char>('a' + id % 26);
+            id /= 26;
+        } while (id);
+        text += word;
+        text += i % 20 == 19 ? '\n' : ' ';
+    }
+    return text;
+}
+
+void bench_word2vec(bench_runner& bench, bool quick) {
+    const size_t tokens = quick ? 5000 : 20000;
+    Word2Vec<float>::TrainingConfig config;
+    config.embedding_dim = 100;
+    config.window_size = 5;
+    config.negative_samples = 5;
+    config.epochs = 1;
+
+    // training reports its sampler and every epoch, keep the table readable
+    std::ostringstream quiet;
+    std::streambuf* console = std::cout.rdbuf(quiet.rdbuf());
+    Word2Vec<float> w2v(config);
+    w2v.load_corpus(bench_corpus(tokens, 2000));
+    w2v.prepare_training_data();
+    // one negative set per window, updates as small GEMMs
+    Word2Vec<float>::TrainingConfig shared_config = config;
+    shared_config.shared_negatives = true;
+    Word2Vec<float> shared(shared_config);
+    shared.load_corpus(bench_corpus(tokens, 2000));
+    shared.prepare_training_data();
+    std::cout.rdbuf(console);
+
+    bench.run("w2v_train", shape_of(tokens, config.embedding_dim), 0, 0, [&] {
+        std::streambuf* saved = std::cout.rdbuf(quiet.rdbuf());
+        w2v.train();
+        std::cout.rdbuf(saved);
+        quiet.str("");
+    }, static_cast<double>(tokens));
+
+    bench.run("w2v_shared", shape_of(tokens, config.embedding_dim), 0, 0, [&] {
+        std::streambuf* saved = std::cout.rdbuf(quiet.rdbuf());
+        shared.train();
+        std::cout.rdbuf(saved);
+        quiet.str("");
+    }, static_cast<double>(tokens));
+
+    const size_t vocab = w2v.get_vocab_size();
+    const double n = static_cast<double>(vocab) * config.embedding_dim;
+    bench.run("w2v_similar", shape_of(vocab, config.embedding_dim), 2 * n, n * sizeof(float), [&] {
+        bench_sink = w2v.most_similar("wb", 10).front().second;
+    });
+}
+
+void write_json(const std::string& path, const bench_runner& bench) {
+    std::ofstream out(path);
+    if (!out.is_open()) {
+        throw std::runtime_error("Error: cannot open " + path);
+    }
+    out << std::setprecision(9) << "{\n  \"roofline\": [\n";
+    size_t i = 0;
+    for (const auto& roof : bench.get_roofs()) {
+        out << "    {\"threads\": " << roof.first << ", \"peak_gflops\": " << roof.second.peak_gflops
+            << ", \"bandwidth_gbs\": " << roof.second.bandwidth_gbs << "}"
+            << (++i < bench.get_roofs().size() ? ",\n" : "\n");
+    }
+    out << "  ],\n  \"results\": [\n";
+    // one result per line, read back by read_baseline
+    const auto& results = bench.get_results();
+    for (i = 0; i < results.size(); ++i) {
+        const bench_result& r = results[i];
+        out << "    {\"name\": \"" << r.name << "\", \"shape\": \"" << r.shape << "\", \"threads\": " << r.threads
+            << ", \"reps\": " << r.reps << ", \"median_s\": " << r.median << ", \"p10_s\": " << r.p10
+            << ", \"p90_s\": " << r.p90 << ", \"gflops\": " << r.gflops << ", \"gbs\": " << r.gbs
+            << ", \"roofline\": " << r.roofline << ", \"items_per_s\": " << r.items_per_s << "}"
+            << (i + 1 < results.size() ? ",\n" : "\n");
+    }
+    out << "  ]\n}\n";
+}
+
+std::string json_field(const std::string& line, const std::string& key) {
+    const std::string tag = "\"" + key + "\": ";
+    size_t pos = line.find(tag);
+    if (pos == std::string::npos) {
+        return "";
+    }
+    pos += tag.size();
+    if (line[pos] == '"') {
+        return line.substr(pos + 1, line.find('"', pos + 1) - pos - 1);
+    }
+    return line.substr(pos, line.find_first_of(",}", pos) - pos);
+}
+
+std::string result_key(const std::string& name, const std::string& shape, const std::string& threads) {
+    return name + " " + shape + " t" + threads;
+}
+
+// Median times of a file written by write_json, keyed by case and threads.
+std::map<std::string, double> read_baseline(const std::string& path) {
+    std::ifstream in(path);
+    if (!in.is_open()) {
+        throw std::runtime_error("Error: cannot open " + path);
+    }
+    std::map<std::string, double> medians;
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.find("\"median_s\"") == std::string::npos) {
+            continue;
+        }
+        medians[result_key(json_field(line, "name"), json_field(line, "shape"), json_field(line, "threads"))] =
+            std::strtod(json_field(line, "median_s").c_str(), nullptr);
+    }
+    return medians;
+}
+
+// Returns the number of regressions.
+size_t compare_baseline(const std::string& path, const bench_runner& bench, double tolerance) {
+    const auto baseline = read_baseline(path);
+    size_t regressions = 0;
+    std::cout << "\nAgainst " << path << " (tolerance " << tolerance * 100 << "%):" << std::endl;
+    for (const bench_result& r : bench.get_results()) {
+        const auto it = baseline.find(result_key(r.name, r.shape, std::to_string(r.threads)));
+        if (it == baseline.end() || it->second <= 0) {
+            continue;
+        }
+        const double change = r.median / it->second - 1;
+        const bool regressed = change > tolerance;
+        regressions += regressed;
+        if (regressed || change < -tolerance) {
+            std::cout << "  " << (regressed ? "REGRESSION " : "improved   ")
+                      << std::left << std::setw(14) << r.name << std::setw(18) << r.shape
+                      << " t" << r.threads << std::right << std::fixed << std::setprecision(1)
+                      << std::setw(8) << change * 100 << "%" << std::defaultfloat << std::endl;
+        }
+    }
+    std::cout << "  " << regressions << " regression(s)" << std::endl;
+    return regressions;
+}
+
+std::vector<int> parse_threads(const std::string& list) {
+    std::vector<int> threads;
+    std::stringstream ss(list);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        threads.push_back(std::max(1, std::atoi(item.c_str())));
+    }
+    return threads;
+}
+
+void usage() {
+    std::cout << "usage: bench.out [--json PATH] [--baseline PATH] [--tolerance FRACTION]\n"
+              << "                 [--filter TEXT] [--threads N,M,...] [--min-time SECONDS] [--quick]\n";
+}
+
+int main(int argc, char** argv) {
+    bench_options opt;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const bool has_value = i + 1 < argc;
+        if (arg == "--json" && has_value) {
+            opt.json_path = argv[++i];
+        } else if (arg == "--baseline" && has_value) {
+            opt.baseline_path = argv[++i];
+        } else if (arg == "--tolerance" && has_value) {
+            opt.tolerance = std::atof(argv[++i]);
+        } else if (arg == "--filter" && has_value) {
+            opt.filter = argv[++i];
+        } else if (arg == "--threads" && has_value) {
+            opt.threads = parse_threads(argv[++i]);
+        } else if (arg == "--min-time" && has_value) {
+            opt.min_time = std::atof(argv[++i]);
+        } else if (arg == "--quick") {
+            opt.quick = true;
+        } else {
+            usage();
+            return arg == "--help" ? 0 : 1;
+        }
+    }
+    if (opt.quick) {
+        opt.min_time = std::min(opt.min_time, 0.05);
+        opt.min_reps = 3;
+        opt.warmup = 1;
+    }
+    if (opt.threads.empty()) {
+        const int max_threads = omp_get_max_threads();
+        opt.threads = {1};
+        if (max_threads > 1) {
+            opt.threads.push_back(max_threads);
+        }
+    }
+
+    bench_runner bench(opt);
+    for (const auto& roof : bench.get_roofs()) {
+        std::cout << "roofline t" << roof.first << ": " << roof.second.peak_gflops << " GFLOPS, "
+                  << roof.second.bandwidth_gbs << " GB/s" << std::endl;
+    }
+    std::cout << std::left << std::setw(14) << "case" << std::setw(18) << "shape" << std::right
+              << std::setw(4) << "thr" << std::setw(11) << "median ms" << std::setw(11) << "p10 ms"
+              << std::setw(11) << "p90 ms" << std::setw(10) << "GFLOPS" << std::setw(10) << "GB/s"
+              << std::setw(9) << "roof" << std::endl;
+
+    bench_gemm(bench, opt.quick);
+    bench_transpose(bench, opt.quick);
+    bench_elementwise(bench, opt.quick);
+    bench_reductions(bench, opt.quick);
+    bench_word2vec(bench, opt.quick);
+
+    if (!opt.json_path.empty()) {
+        write_json(opt.json_path, bench);
+        std::cout << "\nresults written to " << opt.json_path << std::endl;
+    }
+    if (!opt.baseline_path.empty()) {
+        return compare_baseline(opt.baseline_path, bench, opt.tolerance) ? 1 : 0;
+    }
+    return 0;
+}
@@ -0,0 +1,140 @@
+/* alias_table.hpp - O(1) sampling from a fixed discrete distribution */
+/* by ValKmjolnir 2026/10/17 */
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+// xoshiro256** (Blackman and Vigna), seeded through splitmix64. Small state
+// and a handful of instructions per draw, one per thread.
+class fast_rng {
+private:
+    uint64_t s[4];
+
+    static uint64_t rotl(uint64_t x, int k) {
+        return (x << k) | (x >> (64 - k));
+    }
+
+public:
+    explicit fast_rng(uint64_t seed) {
+        for (auto& word : s) {
+            seed += 0x9E3779B97F4A7C15ull;
+            uint64_t z = seed;
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+            word = z ^ (z >> 31);
+        }
+    }
+
+    uint64_t next() {
+        const uint64_t result = rotl(s[1] * 5, 7) * 9;
+        const uint64_t t = s[1] << 17;
+        s[2] ^= s[0];
+        s[3] ^= s[1];
+        s[1] ^= s[2];
+        s[0] ^= s[3];
+        s[2] ^= t;
+        s[3] = rotl(s[3], 45);
+        return result;
+    }
+
+    // uniform in [0, n), multiply-shift instead of a division
+    uint32_t below(uint32_t n) {
+        return static_cast<uint32_t>(((next() >> 32) * n) >> 32);
+    }
+};
+
+// Walker's alias method, built with Vose's algorithm. Index i is drawn with
+// probability weight[i]^power / sum: one random number picks a bucket with
+// its high half and chooses between the bucket and its alias with the low
+// half, so a draw is O(1) and touches one 8-byte entry.
+class alias_table {
+private:
+    struct entry {
+        uint32_t threshold;  // keep the bucket when the low half is below this
+        uint32_t alias;      // full buckets alias themselves
+    };
+
+    std::vector<entry> table;
+    double build_time = 0;
+
+public:
+    alias_table() = default;
+
+    template<typename W>
+    alias_table(const std::vector<W>& weight, double power = 1) {
+        build(weight, power);
+    }
+
+    template<typename W>
+    void build(const std::vector<W>& weight, double power = 1) {
+        const auto begin = std::chrono::steady_clock::now();
+        const size_t n = weight.size();
+        if (!n || n > UINT32_MAX) {
+            throw std::runtime_error("Error: alias table needs 1 to 2^32-1 weights.");
+        }
+
+        std::vector<double> scaled(n);
+        double total = 0;
+        for (size_t i = 0; i < n; ++i) {
+            if (!(weight[i] >= 0)) {
+                throw std::runtime_error("Error: alias table weights must not be negative.");
+            }
+            scaled[i] = power == 1 ? static_cast<double>(weight[i]) : std::pow(static_cast<double>(weight[i]), power);
+            total += scaled[i];
+        }
+        if (!(total > 0) || !std::isfinite(total)) {
+            throw std::runtime_error("Error: alias table weights must have a positive finite sum.");
+        }
+
+        // mean 1 per bucket, then pair every small bucket with a large one
+        std::vector<uint32_t> small, large;
+        for (size_t i = 0; i < n; ++i) {
+            scaled[i] *= n / total;
+            (scaled[i] < 1 ? small : large).push_back(static_cast<uint32_t>(i));
+        }
+        table.assign(n, entry{UINT32_MAX, 0});
+        while (!small.empty() && !large.empty()) {
+            const uint32_t s = small.back();
+            const uint32_t l = large.back();
+            small.pop_back();
+            table[s] = {static_cast<uint32_t>(std::ldexp(std::max(scaled[s], 0.0), 32)), l};
+            scaled[l] -= 1 - scaled[s];
+            if (scaled[l] < 1) {
+                large.pop_back();
+                small.push_back(l);
+            }
+        }
+        // left over by rounding, treat as full
+        for (const uint32_t i : large)
+            table[i] = {UINT32_MAX, i};
+        for (const uint32_t i : small)
+            table[i] = {UINT32_MAX, i};
+
+        build_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    }
+
+    size_t sample(fast_rng& rng) const {
+        const uint64_t r = rng.next();
+        const uint32_t bucket = static_cast<uint32_t>(((r >> 32) * table.size()) >> 32);
+        const entry e = table[bucket];
+        return static_cast<uint32_t>(r) < e.threshold ? bucket : e.alias;
+    }
+
+    // n draws into out
+    void sample(fast_rng& rng, size_t* out, size_t n) const {
+        for (size_t i = 0; i < n; ++i)
+            out[i] = sample(rng);
+    }
+
+    size_t size() const { return table.size(); }
+    bool empty() const { return table.empty(); }
+    size_t memory_bytes() const { return table.capacity() * sizeof(entry); }
+    double build_seconds() const { return build_time; }
+};
@@ -0,0 +1,179 @@
+/* axis_reduce.hpp - Row and column reductions used by matrix_expr.hpp */
+/* by ValKmjolnir 2026/10/17 */
+
+#pragma once
+
+#include "parallel.hpp"
+
+#include <omp.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+// Which axis a reduction collapses:
+//   rows: combines the rows, one value per column, the result is 1 x cols
+//         (e.g. the bias gradient of a batch, one sample per row)
+//   cols: combines the columns, one value per row, the result is rows x 1
+enum class reduce_axis {
+    rows,
+    cols
+};
+
+template<typename T>
+struct reduce_sum {
+    static T identity() { return 0; }
+    T operator()(T a, T b) const { return a + b; }
+};
+
+template<typename T>
+struct reduce_max {
+    static T identity() { return std::numeric_limits<T>::lowest(); }
+    T operator()(T a, T b) const { return b > a ? b : a; }
+};
+
+template<typename T>
+struct reduce_min {
+    static T identity() { return std::numeric_limits<T>::max(); }
+    T operator()(T a, T b) const { return b < a ? b : a; }
+};
+
+// Reductions of f(r, c) over a rows x cols range along one axis.
+//
+// Along the rows the inner loop runs over a row of accumulators, one per
+// column, so it vectorizes across columns; slices of ROW_SLICE rows are
+// folded into separate accumulator rows, split across threads, and then
+// combined pairwise in a fixed order. Along the columns every row is folded
+// into LANES partial results, rows are split across threads. Either way
+// the result does not depend on the thread count.
+template<typename T>
+struct axis_reduce_kernel {
+    static constexpr size_t LANES = 16;
+    static constexpr size_t ROW_SLICE = 64;
+
+private:
+    template<typename Op, typename F>
+    static void fold_rows(size_t begin, size_t end, size_t cols, F& f, Op op, T* acc) {
+        for (size_t r = begin; r < end; ++r) {
+            #pragma omp simd
+            for (size_t c = 0; c < cols; ++c)
+                acc[c] = op(acc[c], f(r, c));
+        }
+    }
+
+    template<typename F>
+    static void argmax_rows(size_t begin, size_t end, size_t cols, F& f, T* best, size_t* index) {
+        for (size_t r = begin; r < end; ++r) {
+            #pragma omp simd
+            for (size_t c = 0; c < cols; ++c) {
+                const T v = f(r, c);
+                index[c] = v > best[c] ? r : index[c];
+                best[c] = v > best[c] ? v : best[c];
+            }
+        }
+    }
+
+    template<typename Op, typename F>
+    static T fold_row(size_t r, size_t cols, F& f, Op op) {
+        T acc[LANES];
+        for (size_t l = 0; l < LANES; ++l)
+            acc[l] = Op::identity();
+
+        size_t c = 0;
+        for (; c + LANES <= cols; c += LANES) {
+            #pragma omp simd
+            for (size_t l = 0; l < LANES; ++l)
+                acc[l] = op(acc[l], f(r, c + l));
+        }
+        for (size_t l = 0; c < cols; ++c, ++l)
+            acc[l] = op(acc[l], f(r, c));
+
+        T result = acc[0];
+        for (size_t l = 1; l < LANES; ++l)
+            result = op(result, acc[l]);
+        return result;
+    }
+
+public:
+    // out[c] = op over r of f(r, c)
+    template<typename Op, typename F>
+    static void over_rows(size_t rows, size_t cols, F&& f, Op op, T* out) {
+        for (size_t c = 0; c < cols; ++c)
+            out[c] = Op::identity();
+        if (rows <= ROW_SLICE) {
+            fold_rows(0, rows, cols, f, op, out);
+            return;
+        }
+
+        const size_t slices = (rows + ROW_SLICE - 1) / ROW_SLICE;
+        std::vector<T> partial(slices * cols, Op::identity());
+        #pragma omp parallel for schedule(static) if(parallel_dispatch::use_parallel(parallel_op::reduction, rows * cols))
+        for (size_t s = 0; s < slices; ++s)
+            fold_rows(s * ROW_SLICE, std::min(rows, (s + 1) * ROW_SLICE), cols, f, op, partial.data() + s * cols);
+        for (size_t step = 1; step < slices; step *= 2) {
+            for (size_t s = 0; s + step < slices; s += 2 * step) {
+                T* dst = partial.data() + s * cols;
+                const T* src = partial.data() + (s + step) * cols;
+                #pragma omp simd
+                for (size_t c = 0; c < cols; ++c)
+                    dst[c] = op(dst[c], src[c]);
+            }
+        }
+        for (size_t c = 0; c < cols; ++c)
+            out[c] = op(out[c], partial[c]);
+    }
+
+    // out[r] = op over c of f(r, c)
+    template<typename Op, typename F>
+    static void over_cols(size_t rows, size_t cols, F&& f, Op op, T* out) {
+        #pragma omp parallel for schedule(static) if(parallel_dispatch::use_parallel(parallel_op::reduction, rows * cols))
+        for (size_t r = 0; r < rows; ++r)
+            out[r] = fold_row(r, cols, f, op);
+    }
+
+    // index[c] = first r with the largest f(r, c)
+    template<typename F>
+    static void argmax_over_rows(size_t rows, size_t cols, F&& f, size_t* index) {
+        std::vector<T> best(cols, std::numeric_limits<T>::lowest());
+        for (size_t c = 0; c < cols; ++c)
+            index[c] = 0;
+        if (rows < 2 || !parallel_dispatch::use_parallel(parallel_op::reduction, rows * cols)) {
+            argmax_rows(0, rows, cols, f, best.data(), index);
+            return;
+        }
+
+        const size_t threads = omp_get_max_threads();
+        std::vector<T> partial_best(threads * cols, std::numeric_limits<T>::lowest());
+        std::vector<size_t> partial_index(threads * cols, 0);
+        #pragma omp parallel num_threads(threads)
+        {
+            const size_t t = omp_get_thread_num();
+            const size_t n = omp_get_num_threads();
+            argmax_rows(rows * t / n, rows * (t + 1) / n, cols, f,
+                        partial_best.data() + t * cols, partial_index.data() + t * cols);
+        }
+        // earlier slices win ties, so the first maximum is kept
+        for (size_t t = 0; t < threads; ++t) {
+            for (size_t c = 0; c < cols; ++c) {
+                if (partial_best[t * cols + c] > best[c]) {
+                    best[c] = partial_best[t * cols + c];
+                    index[c] = partial_index[t * cols + c];
+                }
+            }
+        }
+    }
+
+    // index[r] = first c with the largest f(r, c)
+    template<typename F>
+    static void argmax_over_cols(size_t rows, size_t cols, F&& f, size_t* index) {
+        #pragma omp parallel for schedule(static) if(parallel_dispatch::use_parallel(parallel_op::reduction, rows * cols))
+        for (size_t r = 0; r < rows; ++r) {
+            const T max_val = fold_row(r, cols, f, reduce_max<T>());
+            size_t c = 0;
+            while (c < cols && !(f(r, c) == max_val))
+                ++c;
+            index[r] = c < cols ? c : 0;
+        }
+    }
+};
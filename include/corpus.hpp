@@ -0,0 +1,188 @@
+/* corpus.hpp - Streaming tokenizer and word counts for word2vec.hpp */
+/* by ValKmjolnir 2026/10/17 */
+
+#pragma once
+
+#include "file_mapping.hpp"
+#include "parallel.hpp"
+
+#include <omp.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Every distinct word of a corpus with its count. Ids follow the order of
+// first appearance in the text.
+class token_dictionary {
+private:
+    std::unordered_map<std::string, uint32_t> index;
+    std::vector<std::string> words;
+    std::vector<size_t> counts;
+
+public:
+    static constexpr uint32_t NONE = UINT32_MAX;
+
+    uint32_t insert(const std::string& word, size_t count) {
+        const auto it = index.find(word);
+        if (it != index.end()) {
+            counts[it->second] += count;
+            return it->second;
+        }
+        if (words.size() >= NONE) {
+            throw std::runtime_error("Error: corpus has more than 2^32-1 distinct words.");
+        }
+        const uint32_t id = static_cast<uint32_t>(words.size());
+        index.emplace(word, id);
+        words.push_back(word);
+        counts.push_back(count);
+        return id;
+    }
+
+    uint32_t find(const std::string& word) const {
+        const auto it = index.find(word);
+        return it == index.end() ? NONE : it->second;
+    }
+
+    void clear() {
+        index.clear();
+        words.clear();
+        counts.clear();
+    }
+
+    size_t size() const { return words.size(); }
+    const std::string& word(uint32_t id) const { return words[id]; }
+    size_t count(uint32_t id) const { return counts[id]; }
+};
+
+// Splits text into words at whitespace, keeps only the letters of each
+// word, lowercased, and drops words without letters ("Don't!" -> "dont").
+//
+// A block of text is cut into pieces at whitespace. Every piece is
+// tokenized by one thread into its own dictionary and id stream, then the
+// dictionaries are merged in piece order, which keeps the order of first
+// appearance, and the streams are remapped to global ids in parallel.
+// Files are mapped and read in CHUNK byte rounds, so memory beyond the
+// token ids stays bounded by the chunk whatever the file size.
+struct corpus_tokenizer {
+    static constexpr size_t CHUNK = static_cast<size_t>(64) << 20;
+
+    static bool is_space(char c) {
+        return c == ' ' || c == '\n' || c == '\r' || c == '\t' || c == '\f' || c == '\v';
+    }
+
+private:
+    struct piece {
+        std::unordered_map<std::string, uint32_t> index;
+        std::vector<std::string> words;
+        std::vector<size_t> counts;
+        std::vector<uint32_t> tokens;
+    };
+
+    static void tokenize(const char* p, const char* end, piece& out) {
+        std::string word;
+        while (p < end) {
+            while (p < end && is_space(*p))
+                ++p;
+            word.clear();
+            for (; p < end && !is_space(*p); ++p) {
+                const unsigned char c = static_cast<unsigned char>(*p);
+                if (std::isalpha(c)) {
+                    word += static_cast<char>(std::tolower(c));
+                }
+            }
+            if (word.empty()) {
+                continue;
+            }
+            auto it = out.index.find(word);
+            if (it == out.index.end()) {
+                it = out.index.emplace(word, static_cast<uint32_t>(out.words.size())).first;
+                out.words.push_back(word);
+                out.counts.push_back(0);
+            }
+            ++out.counts[it->second];
+            out.tokens.push_back(it->second);
+        }
+    }
+
+public:
+    // Appends the words of [begin, end) to tokens as ids of dict and adds
+    // their counts. Returns the number of words.
+    static size_t append(const char* begin, const char* end, token_dictionary& dict, std::vector<uint32_t>& tokens) {
+        const size_t length = end - begin;
+        // about 8 characters per word
+        const size_t pieces = parallel_dispatch::use_parallel(parallel_op::transcendental, length / 8)
+            ? static_cast<size_t>(omp_get_max_threads()) * 4
+            : 1;
+        std::vector<const char*> cut(pieces + 1, end);
+        cut[0] = begin;
+        for (size_t k = 1; k < pieces; ++k) {
+            const char* p = std::max(cut[k - 1], begin + length * k / pieces);
+            while (p < end && !is_space(*p))
+                ++p;
+            cut[k] = p;
+        }
+
+        std::vector<piece> part(pieces);
+        #pragma omp parallel for schedule(dynamic) if(pieces > 1)
+        for (size_t k = 0; k < pieces; ++k)
+            tokenize(cut[k], cut[k + 1], part[k]);
+
+        std::vector<size_t> first(pieces + 1, tokens.size());
+        std::vector<std::vector<uint32_t>> remap(pieces);
+        for (size_t k = 0; k < pieces; ++k) {
+            remap[k].resize(part[k].words.size());
+            for (size_t w = 0; w < part[k].words.size(); ++w)
+                remap[k][w] = dict.insert(part[k].words[w], part[k].counts[w]);
+            part[k].index.clear();
+            first[k + 1] = first[k] + part[k].tokens.size();
+        }
+
+        tokens.resize(first[pieces]);
+        #pragma omp parallel for schedule(dynamic) if(pieces > 1)
+        for (size_t k = 0; k < pieces; ++k) {
+            const std::vector<uint32_t>& local = part[k].tokens;
+            for (size_t i = 0; i < local.size(); ++i)
+                tokens[first[k] + i] = remap[k][local[i]];
+        }
+        return first[pieces] - first[0];
+    }
+
+    // append() over a mapped file, chunk bytes at a time. Pages already
+    // tokenized are dropped from the mapping as it goes.
+    static size_t append_file(const std::string& path, token_dictionary& dict, std::vector<uint32_t>& tokens,
+                              size_t chunk = CHUNK) {
+        const file_mapping file(path, map_mode::read_only);
+        const char* const begin = file.data();
+        const char* const end = begin + file.size();
+        if (!begin) {
+            return 0;
+        }
+        ::madvise(file.data(), file.size(), MADV_SEQUENTIAL);
+        const size_t page = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+
+        size_t words = 0;
+        size_t released = 0;
+        for (const char* p = begin; p < end;) {
+            const char* cut = p + std::min(chunk, static_cast<size_t>(end - p));
+            while (cut < end && !is_space(*cut))
+                ++cut;
+            words += append(p, cut, dict, tokens);
+            p = cut;
+
+            const size_t done = static_cast<size_t>(p - begin) / page * page;
+            if (done > released) {
+                ::madvise(file.data() + released, done - released, MADV_DONTNEED);
+                released = done;
+            }
+        }
+        return words;
+    }
+};
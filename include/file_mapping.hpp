@@ -0,0 +1,66 @@
+/* file_mapping.hpp - Whole files mapped into memory with mmap */
+/* by ValKmjolnir 2026/10/17 */
+
+#pragma once
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+
+enum class map_mode {
+    read_only,      // shared read-only pages, writing through them faults
+    copy_on_write   // private pages, writes are copied and never reach the file
+};
+
+// A whole file mapped into memory, unmapped when the last owner goes away.
+// Read-only mappings of the same file share page cache pages across processes.
+class file_mapping {
+private:
+    char* addr;
+    size_t length;
+    map_mode mode;
+
+public:
+    file_mapping(const std::string& path, map_mode m): addr(nullptr), length(0), mode(m) {
+        const int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw std::runtime_error("Error: cannot open " + path);
+        }
+        struct stat st;
+        if (::fstat(fd, &st) != 0) {
+            ::close(fd);
+            throw std::runtime_error("Error: cannot stat " + path);
+        }
+        length = static_cast<size_t>(st.st_size);
+        if (length) {
+            void* p = ::mmap(nullptr, length,
+                             mode == map_mode::read_only ? PROT_READ : PROT_READ | PROT_WRITE,
+                             mode == map_mode::read_only ? MAP_SHARED : MAP_PRIVATE,
+                             fd, 0);
+            if (p == MAP_FAILED) {
+                ::close(fd);
+                throw std::runtime_error("Error: cannot map " + path);
+            }
+            addr = static_cast<char*>(p);
+        }
+        ::close(fd);
+    }
+
+    ~file_mapping() {
+        if (addr) {
+            ::munmap(addr, length);
+        }
+    }
+
+    file_mapping(const file_mapping&) = delete;
+    file_mapping& operator=(const file_mapping&) = delete;
+
+    char* data() const { return addr; }
+    size_t size() const { return length; }
+    map_mode get_mode() const { return mode; }
+};
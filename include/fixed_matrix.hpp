@@ -0,0 +1,294 @@
+/* fixed_matrix.hpp - Compile-time shaped matrix with inline storage */
+/* by ValKmjolnir 2026/10/17 */
+
+#pragma once
+
+#include "matrix.hpp"
+
+#include <cstddef>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+// Loops over at most this many elements are expanded into straight-line code.
+constexpr size_t FIXED_UNROLL_LIMIT = 64;
+
+template<typename F, size_t... I>
+void fixed_for_impl(F&& f, std::index_sequence<I...>) {
+    (f(I), ...);
+}
+
+// f(0), f(1), ... f(N - 1). Above the unroll limit the calls run as one
+// `omp simd` loop, so f(i) must not depend on another iteration; use an
+// explicit reduction loop for sums.
+template<size_t N, typename F>
+void fixed_for(F&& f) {
+    if constexpr (N <= FIXED_UNROLL_LIMIT) {
+        fixed_for_impl(f, std::make_index_sequence<N>());
+    } else {
+        #pragma omp simd
+        for (size_t i = 0; i < N; ++i)
+            f(i);
+    }
+}
+
+// R x C matrix stored inline, so it lives on the stack or inside its owner
+// and never touches the heap. Shapes are template arguments: operands of
+// +, -, hadamard and * must agree at compile time, there are no runtime
+// size checks, and loops over the elements are unrolled.
+//
+// Interop with matrix<T>: construct from a matrix (shape checked once, at
+// runtime), to_matrix() for a heap copy, view() for a matrix_view that works
+// with gemm() and expression templates without copying.
+template<typename T, size_t R, size_t C>
+class fixed_matrix {
+    static_assert(std::is_floating_point<T>::value, "T must be floating point type");
+    static_assert(R > 0 && C > 0, "fixed_matrix size must not be zero");
+
+    template<typename, size_t, size_t>
+    friend class fixed_matrix;
+
+public:
+    using value_type = T;
+    static constexpr size_t SIZE = R * C;
+
+private:
+    // 64-byte aligned like matrix_pool buffers: the compiler vectorizes the
+    // element loops with aligned full-width loads and stores.
+    alignas(64) T num[SIZE];
+
+    template<typename F>
+    fixed_matrix map(F f) const {
+        fixed_matrix result;
+        fixed_for<SIZE>([&](size_t i) { result.num[i] = f(num[i]); });
+        return result;
+    }
+
+    template<typename F>
+    fixed_matrix zip(const fixed_matrix& B, F f) const {
+        fixed_matrix result;
+        fixed_for<SIZE>([&](size_t i) { result.num[i] = f(num[i], B.num[i]); });
+        return result;
+    }
+
+public:
+    fixed_matrix(): num{} {}
+
+    explicit fixed_matrix(const matrix<T>& m) {
+        if (m.get_row() != R || m.get_col() != C) {
+            report_expr_mismatch("fixed_matrix", R, C, m.get_row(), m.get_col());
+        }
+        const T* src = m.data();
+        fixed_for<SIZE>([&](size_t i) { num[i] = src[i]; });
+    }
+
+    static constexpr size_t get_row() { return R; }
+    static constexpr size_t get_col() { return C; }
+
+    T* operator[](const size_t addr) {
+        return addr >= R ? nullptr : &num[addr * C];
+    }
+
+    const T* operator[](const size_t addr) const {
+        return addr >= R ? nullptr : &num[addr * C];
+    }
+
+    T* data() { return num; }
+    const T* data() const { return num; }
+
+    matrix_view<T> view() { return matrix_view<T>(num, R, C, C); }
+    matrix_view<const T> view() const { return matrix_view<const T>(num, R, C, C); }
+
+    matrix<T> to_matrix() const {
+        matrix<T> result(R, C);
+        T* dst = result.data();
+        fixed_for<SIZE>([&](size_t i) { dst[i] = num[i]; });
+        return result;
+    }
+
+    void random_init(const uint64_t seed = random_config::next_seed()) {
+        random_kernel<T>::uniform(SIZE, num, -1, 1, seed);
+    }
+
+public:
+    fixed_matrix& operator+=(const fixed_matrix& B) {
+        fixed_for<SIZE>([&](size_t i) { num[i] += B.num[i]; });
+        return *this;
+    }
+
+    fixed_matrix& operator-=(const fixed_matrix& B) {
+        fixed_for<SIZE>([&](size_t i) { num[i] -= B.num[i]; });
+        return *this;
+    }
+
+    fixed_matrix& operator*=(const T B) {
+        fixed_for<SIZE>([&](size_t i) { num[i] *= B; });
+        return *this;
+    }
+
+    fixed_matrix& operator/=(const T B) {
+        fixed_for<SIZE>([&](size_t i) { num[i] /= B; });
+        return *this;
+    }
+
+    friend fixed_matrix operator+(const fixed_matrix& A, const fixed_matrix& B) {
+        return A.zip(B, [](T a, T b) { return a + b; });
+    }
+
+    friend fixed_matrix operator-(const fixed_matrix& A, const fixed_matrix& B) {
+        return A.zip(B, [](T a, T b) { return a - b; });
+    }
+
+    friend fixed_matrix operator-(const fixed_matrix& A) {
+        return A.map([](T a) { return -a; });
+    }
+
+    friend fixed_matrix operator*(const fixed_matrix& A, const T s) {
+        return A.map([=](T a) { return a * s; });
+    }
+
+    friend fixed_matrix operator*(const T s, const fixed_matrix& A) {
+        return A.map([=](T a) { return a * s; });
+    }
+
+    friend fixed_matrix operator/(const fixed_matrix& A, const T s) {
+        return A.map([=](T a) { return a / s; });
+    }
+
+    fixed_matrix hadamard(const fixed_matrix& B) const {
+        return zip(B, [](T a, T b) { return a * b; });
+    }
+
+    // (R x C) * (C x K), the inner dimensions are matched by the signature.
+    template<size_t K>
+    fixed_matrix<T, R, K> operator*(const fixed_matrix<T, C, K>& B) const {
+        fixed_matrix<T, R, K> result;
+        if constexpr (K <= SMALL_GEMM_MAX_N) {
+            small_gemm_fixed<T, K>::run(R, C, num, C, 1, B.num, K, result.num, K, 1, 0);
+        } else {
+            for (size_t i = 0; i < R; ++i)
+                for (size_t p = 0; p < C; ++p) {
+                    const T a = num[i * C + p];
+                    #pragma omp simd
+                    for (size_t j = 0; j < K; ++j)
+                        result.num[i * K + j] += a * B.num[p * K + j];
+                }
+        }
+        return result;
+    }
+
+    // this^T * B without building the transpose, A is read with swapped strides.
+    template<size_t K>
+    fixed_matrix<T, C, K> transpose_mul(const fixed_matrix<T, R, K>& B) const {
+        fixed_matrix<T, C, K> result;
+        if constexpr (K <= SMALL_GEMM_MAX_N) {
+            small_gemm_fixed<T, K>::run(C, R, num, 1, C, B.num, K, result.num, K, 1, 0);
+        } else {
+            for (size_t p = 0; p < R; ++p)
+                for (size_t i = 0; i < C; ++i) {
+                    const T a = num[p * C + i];
+                    #pragma omp simd
+                    for (size_t j = 0; j < K; ++j)
+                        result.num[i * K + j] += a * B.num[p * K + j];
+                }
+        }
+        return result;
+    }
+
+    // this * B^T without building the transpose, each element is a row-row dot.
+    template<size_t K>
+    fixed_matrix<T, R, K> mul_transpose(const fixed_matrix<T, K, C>& B) const {
+        fixed_matrix<T, R, K> result;
+        for (size_t i = 0; i < R; ++i)
+            for (size_t j = 0; j < K; ++j) {
+                T s = 0;
+                #pragma omp simd reduction(+:s)
+                for (size_t p = 0; p < C; ++p)
+                    s += num[i * C + p] * B.num[j * C + p];
+                result.num[i * K + j] = s;
+            }
+        return result;
+    }
+
+    // adds the row vector v to every row
+    fixed_matrix add_row(const fixed_matrix<T, 1, C>& v) const {
+        fixed_matrix result;
+        fixed_for<SIZE>([&](size_t i) { result.num[i] = num[i] + v.num[i % C]; });
+        return result;
+    }
+
+    fixed_matrix<T, C, R> transpose() const {
+        fixed_matrix<T, C, R> result;
+        fixed_for<SIZE>([&](size_t i) { result.num[(i % C) * R + i / C] = num[i]; });
+        return result;
+    }
+
+public:
+    T sum() const {
+        T s = 0;
+        if constexpr (SIZE <= FIXED_UNROLL_LIMIT) {
+            fixed_for<SIZE>([&](size_t i) { s += num[i]; });
+        } else {
+            #pragma omp simd reduction(+:s)
+            for (size_t i = 0; i < SIZE; ++i)
+                s += num[i];
+        }
+        return s;
+    }
+
+    fixed_matrix sigmoid() const {
+        return with_math_mode([&](auto m) {
+            return map([=](T x) { return math_sigmoid(x, m); });
+        });
+    }
+
+    fixed_matrix sigmoid_derivative() const {
+        return map([](T x) { return x * (1 - x); });
+    }
+
+    fixed_matrix tanh() const {
+        return with_math_mode([&](auto m) {
+            return map([=](T x) { return math_tanh(x, m); });
+        });
+    }
+
+    fixed_matrix tanh_derivative() const {
+        return map([](T x) { return 1 - x * x; });
+    }
+
+    fixed_matrix relu() const {
+        return map([](T x) { return x > 0 ? x : 0; });
+    }
+
+    fixed_matrix relu_derivative() const {
+        return map([](T x) { return x > 0 ? 1 : 0; });
+    }
+
+    fixed_matrix pow(const T B) const {
+        if (B == 2) {
+            return map([](T x) { return x * x; });
+        }
+        return map([=](T x) { return std::pow(x, B); });
+    }
+
+public:
+    friend std::ostream& operator<<(std::ostream& out, const fixed_matrix& m) {
+        text_codec<T>::write(out, m.num, R, C);
+        return out;
+    }
+
+    // Same format as matrix<T>::save, files are interchangeable.
+    void save(std::ostream& out) const {
+        write_matrix(out, num, R, C);
+    }
+
+    void load(std::istream& in) {
+        const matrix_record rec = read_matrix_header<T>(in);
+        if (rec.rows != R || rec.cols != C) {
+            report_expr_mismatch("fixed_matrix::load", R, C, rec.rows, rec.cols);
+        }
+        read_matrix_data(in, rec, num);
+    }
+};
@@ -0,0 +1,819 @@
+/* gemm.hpp - Packed panel GEMM kernel used by matrix.hpp */
+/* by ValKmjolnir 2026/10/17 */
+
+#pragma once
+
+#include "parallel.hpp"
+
+#include <omp.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#if defined(__AVX512F__) || defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+// Aligned, grow-only scratch buffer for packed panels.
+// Kept thread_local by the kernel so steady-state calls never allocate.
+template<typename T>
+class aligned_buffer {
+private:
+    static constexpr size_t ALIGNMENT = 64;
+
+    T* data = nullptr;
+    size_t capacity = 0;
+
+public:
+    aligned_buffer() = default;
+    aligned_buffer(const aligned_buffer&) = delete;
+    aligned_buffer& operator=(const aligned_buffer&) = delete;
+
+    ~aligned_buffer() {
+        if (data) {
+            ::operator delete(data, std::align_val_t(ALIGNMENT));
+        }
+    }
+
+    T* reserve(size_t size) {
+        if (size > capacity) {
+            if (data) {
+                ::operator delete(data, std::align_val_t(ALIGNMENT));
+            }
+            data = static_cast<T*>(::operator new(size * sizeof(T), std::align_val_t(ALIGNMENT)));
+            capacity = size;
+        }
+        return data;
+    }
+};
+
+// One SIMD register worth of T for the widest instruction set enabled at
+// compile time. Build with -march=native to get the AVX2/AVX-512 paths;
+// other targets fall back to a scalar "register" of width 1.
+template<typename T>
+struct simd_reg {
+    using reg = T;
+    static constexpr size_t width = 1;
+
+    static reg zero() { return 0; }
+    static reg broadcast(T v) { return v; }
+    static reg load(const T* p) { return *p; }
+    static reg loadu(const T* p) { return *p; }
+    static void storeu(T* p, reg v) { *p = v; }
+    static reg mul(reg a, reg b) { return a * b; }
+    static reg fmadd(reg a, reg b, reg c) { return a * b + c; }
+};
+
+#if defined(__AVX512F__)
+template<>
+struct simd_reg<float> {
+    using reg = __m512;
+    static constexpr size_t width = 16;
+
+    static reg zero() { return _mm512_setzero_ps(); }
+    static reg broadcast(float v) { return _mm512_set1_ps(v); }
+    static reg load(const float* p) { return _mm512_load_ps(p); }
+    static reg loadu(const float* p) { return _mm512_loadu_ps(p); }
+    static void storeu(float* p, reg v) { _mm512_storeu_ps(p, v); }
+    static reg mul(reg a, reg b) { return _mm512_mul_ps(a, b); }
+    static reg fmadd(reg a, reg b, reg c) { return _mm512_fmadd_ps(a, b, c); }
+};
+
+template<>
+struct simd_reg<double> {
+    using reg = __m512d;
+    static constexpr size_t width = 8;
+
+    static reg zero() { return _mm512_setzero_pd(); }
+    static reg broadcast(double v) { return _mm512_set1_pd(v); }
+    static reg load(const double* p) { return _mm512_load_pd(p); }
+    static reg loadu(const double* p) { return _mm512_loadu_pd(p); }
+    static void storeu(double* p, reg v) { _mm512_storeu_pd(p, v); }
+    static reg mul(reg a, reg b) { return _mm512_mul_pd(a, b); }
+    static reg fmadd(reg a, reg b, reg c) { return _mm512_fmadd_pd(a, b, c); }
+};
+#elif defined(__AVX2__) && defined(__FMA__)
+template<>
+struct simd_reg<float> {
+    using reg = __m256;
+    static constexpr size_t width = 8;
+
+    static reg zero() { return _mm256_setzero_ps(); }
+    static reg broadcast(float v) { return _mm256_set1_ps(v); }
+    static reg load(const float* p) { return _mm256_load_ps(p); }
+    static reg loadu(const float* p) { return _mm256_loadu_ps(p); }
+    static void storeu(float* p, reg v) { _mm256_storeu_ps(p, v); }
+    static reg mul(reg a, reg b) { return _mm256_mul_ps(a, b); }
+    static reg fmadd(reg a, reg b, reg c) { return _mm256_fmadd_ps(a, b, c); }
+};
+
+template<>
+struct simd_reg<double> {
+    using reg = __m256d;
+    static constexpr size_t width = 4;
+
+    static reg zero() { return _mm256_setzero_pd(); }
+    static reg broadcast(double v) { return _mm256_set1_pd(v); }
+    static reg load(const double* p) { return _mm256_load_pd(p); }
+    static reg loadu(const double* p) { return _mm256_loadu_pd(p); }
+    static void storeu(double* p, reg v) { _mm256_storeu_pd(p, v); }
+    static reg mul(reg a, reg b) { return _mm256_mul_pd(a, b); }
+    static reg fmadd(reg a, reg b, reg c) { return _mm256_fmadd_pd(a, b, c); }
+};
+#elif defined(__SSE2__)
+template<>
+struct simd_reg<float> {
+    using reg = __m128;
+    static constexpr size_t width = 4;
+
+    static reg zero() { return _mm_setzero_ps(); }
+    static reg broadcast(float v) { return _mm_set1_ps(v); }
+    static reg load(const float* p) { return _mm_load_ps(p); }
+    static reg loadu(const float* p) { return _mm_loadu_ps(p); }
+    static void storeu(float* p, reg v) { _mm_storeu_ps(p, v); }
+    static reg mul(reg a, reg b) { return _mm_mul_ps(a, b); }
+    static reg fmadd(reg a, reg b, reg c) { return _mm_add_ps(_mm_mul_ps(a, b), c); }
+};
+
+template<>
+struct simd_reg<double> {
+    using reg = __m128d;
+    static constexpr size_t width = 2;
+
+    static reg zero() { return _mm_setzero_pd(); }
+    static reg broadcast(double v) { return _mm_set1_pd(v); }
+    static reg load(const double* p) { return _mm_load_pd(p); }
+    static reg loadu(const double* p) { return _mm_loadu_pd(p); }
+    static void storeu(double* p, reg v) { _mm_storeu_pd(p, v); }
+    static reg mul(reg a, reg b) { return _mm_mul_pd(a, b); }
+    static reg fmadd(reg a, reg b, reg c) { return _mm_add_pd(_mm_mul_pd(a, b), c); }
+};
+#endif
+
+// Vector registers of the instruction set above: 32 with AVX-512, 16 with
+// AVX2 or SSE2.
+#if defined(__AVX512F__)
+constexpr size_t simd_register_count = 32;
+#else
+constexpr size_t simd_register_count = 16;
+#endif
+
+// Register of exactly W elements of T, for kernels whose width is a small
+// compile-time constant rather than "as wide as possible". W == 1 is a
+// scalar and always available; wider ones exist when the ISA has them.
+template<typename T, size_t W>
+struct simd_vec {
+    static constexpr bool available = false;
+};
+
+template<typename T>
+struct simd_vec<T, 1> {
+    using reg = T;
+    static constexpr bool available = true;
+
+    static reg zero() { return 0; }
+    static reg broadcast(T v) { return v; }
+    static reg loadu(const T* p) { return *p; }
+    static void storeu(T* p, reg v) { *p = v; }
+    static reg add(reg a, reg b) { return a + b; }
+    static reg mul(reg a, reg b) { return a * b; }
+    static reg fmadd(reg a, reg b, reg c) { return a * b + c; }
+};
+
+#if defined(__AVX512F__)
+template<>
+struct simd_vec<float, 16> {
+    using reg = __m512;
+    static constexpr bool available = true;
+
+    static reg zero() { return _mm512_setzero_ps(); }
+    static reg broadcast(float v) { return _mm512_set1_ps(v); }
+    static reg loadu(const float* p) { return _mm512_loadu_ps(p); }
+    static void storeu(float* p, reg v) { _mm512_storeu_ps(p, v); }
+    static reg add(reg a, reg b) { return _mm512_add_ps(a, b); }
+    static reg mul(reg a, reg b) { return _mm512_mul_ps(a, b); }
+    static reg fmadd(reg a, reg b, reg c) { return _mm512_fmadd_ps(a, b, c); }
+};
+
+template<>
+struct simd_vec<double, 8> {
+    using reg = __m512d;
+    static constexpr bool available = true;
+
+    static reg zero() { return _mm512_setzero_pd(); }
+    static reg broadcast(double v) { return _mm512_set1_pd(v); }
+    static reg loadu(const double* p) { return _mm512_loadu_pd(p); }
+    static void storeu(double* p, reg v) { _mm512_storeu_pd(p, v); }
+    static reg add(reg a, reg b) { return _mm512_add_pd(a, b); }
+    static reg mul(reg a, reg b) { return _mm512_mul_pd(a, b); }
+    static reg fmadd(reg a, reg b, reg c) { return _mm512_fmadd_pd(a, b, c); }
+};
+#endif
+
+#if defined(__AVX__)
+template<>
+struct simd_vec<float, 8> {
+    using reg = __m256;
+    static constexpr bool available = true;
+
+    static reg zero() { return _mm256_setzero_ps(); }
+    static reg broadcast(float v) { return _mm256_set1_ps(v); }
+    static reg loadu(const float* p) { return _mm256_loadu_ps(p); }
+    static void storeu(float* p, reg v) { _mm256_storeu_ps(p, v); }
+    static reg add(reg a, reg b) { return _mm256_add_ps(a, b); }
+    static reg mul(reg a, reg b) { return _mm256_mul_ps(a, b); }
+#if defined(__FMA__)
+    static reg fmadd(reg a, reg b, reg c) { return _mm256_fmadd_ps(a, b, c); }
+#else
+    static reg fmadd(reg a, reg b, reg c) { return _mm256_add_ps(_mm256_mul_ps(a, b), c); }
+#endif
+};
+
+template<>
+struct simd_vec<double, 4> {
+    using reg = __m256d;
+    static constexpr bool available = true;
+
+    static reg zero() { return _mm256_setzero_pd(); }
+    static reg broadcast(double v) { return _mm256_set1_pd(v); }
+    static reg loadu(const double* p) { return _mm256_loadu_pd(p); }
+    static void storeu(double* p, reg v) { _mm256_storeu_pd(p, v); }
+    static reg add(reg a, reg b) { return _mm256_add_pd(a, b); }
+    static reg mul(reg a, reg b) { return _mm256_mul_pd(a, b); }
+#if defined(__FMA__)
+    static reg fmadd(reg a, reg b, reg c) { return _mm256_fmadd_pd(a, b, c); }
+#else
+    static reg fmadd(reg a, reg b, reg c) { return _mm256_add_pd(_mm256_mul_pd(a, b), c); }
+#endif
+};
+#endif
+
+#if defined(__SSE2__)
+template<>
+struct simd_vec<float, 4> {
+    using reg = __m128;
+    static constexpr bool available = true;
+
+    static reg zero() { return _mm_setzero_ps(); }
+    static reg broadcast(float v) { return _mm_set1_ps(v); }
+    static reg loadu(const float* p) { return _mm_loadu_ps(p); }
+    static void storeu(float* p, reg v) { _mm_storeu_ps(p, v); }
+    static reg add(reg a, reg b) { return _mm_add_ps(a, b); }
+    static reg mul(reg a, reg b) { return _mm_mul_ps(a, b); }
+    static reg fmadd(reg a, reg b, reg c) { return _mm_add_ps(_mm_mul_ps(a, b), c); }
+};
+
+template<>
+struct simd_vec<double, 2> {
+    using reg = __m128d;
+    static constexpr bool available = true;
+
+    static reg zero() { return _mm_setzero_pd(); }
+    static reg broadcast(double v) { return _mm_set1_pd(v); }
+    static reg loadu(const double* p) { return _mm_loadu_pd(p); }
+    static void storeu(double* p, reg v) { _mm_storeu_pd(p, v); }
+    static reg add(reg a, reg b) { return _mm_add_pd(a, b); }
+    static reg mul(reg a, reg b) { return _mm_mul_pd(a, b); }
+    static reg fmadd(reg a, reg b, reg c) { return _mm_add_pd(_mm_mul_pd(a, b), c); }
+};
+#endif
+
+// Widest available simd_vec<T, W> with W <= n.
+template<typename T>
+constexpr size_t simd_vec_width(size_t n) {
+    return n >= 16 && simd_vec<T, 16>::available ? 16
+         : n >= 8 && simd_vec<T, 8>::available ? 8
+         : n >= 4 && simd_vec<T, 4>::available ? 4
+         : n >= 2 && simd_vec<T, 2>::available ? 2
+         : 1;
+}
+
+// Register tile and cache blocking parameters.
+//   MR x NR : micro tile held in registers, MR * NV accumulators plus NV
+//             loads of B and one broadcast of A must fit the register file:
+//             12 x 2 + 3 of 32 with AVX-512, 6 x 2 + 3 of 16 otherwise
+//   KC      : depth of a packed panel, KC * NR * sizeof(T) stays in L1
+//   MC      : rows of packed A, MC * KC * sizeof(T) stays in L2
+//   NC      : cols of packed B, KC * NC * sizeof(T) stays in L3
+template<typename T>
+struct gemm_blocking {
+    static constexpr size_t width = simd_reg<T>::width;
+    static constexpr size_t NV = width == 1 ? 8 : 2;
+    static constexpr size_t MR = width == 1 ? 4 : (simd_register_count >= 32 ? 12 : 6);
+    static constexpr size_t NR = NV * width;
+    static constexpr size_t KC = 256;
+    static constexpr size_t MC = MR * (MR == 12 ? 8 : 16);
+    static constexpr size_t NC = NR * (4096 / NR);
+};
+
+// N accumulators for one output row, split greedily into the widest
+// registers that fit (e.g. 13 floats -> 8 + 4 + 1 with AVX).
+template<typename T, size_t N, size_t W = simd_vec_width<T>(N)>
+struct small_gemm_row {
+    using V = simd_vec<T, W>;
+    typename V::reg acc;
+    small_gemm_row<T, N - W> rest;
+
+    void zero() {
+        acc = V::zero();
+        rest.zero();
+    }
+
+    // acc += a * b[0, N)
+    void fma(T a, const T* b) {
+        acc = V::fmadd(V::broadcast(a), V::loadu(b), acc);
+        rest.fma(a, b + W);
+    }
+
+    // c[0, N) = alpha * (acc + other.acc) + beta * c[0, N)
+    void store(const small_gemm_row& other, T* c, T alpha, T beta) const {
+        typename V::reg v = V::mul(V::broadcast(alpha), V::add(acc, other.acc));
+        if (beta != 0) {
+            v = V::fmadd(V::broadcast(beta), V::loadu(c), v);
+        }
+        V::storeu(c, v);
+        rest.store(other.rest, c + W, alpha, beta);
+    }
+};
+
+template<typename T, size_t W>
+struct small_gemm_row<T, 0, W> {
+    void zero() {}
+    void fma(T, const T*) {}
+    void store(const small_gemm_row&, T*, T, T) const {}
+};
+
+// Tiny product with N output columns fixed at compile time. Every
+// accumulator is a named register and all column loops are unrolled by the
+// templates above. Rows go 4 at a time and even/odd k alternate between two
+// accumulator sets, so short products are not bound by one FMA chain.
+template<typename T, size_t N>
+struct small_gemm_fixed {
+private:
+    using row_acc = small_gemm_row<T, N>;
+
+    template<size_t R>
+    static void rows(size_t k,
+                     const T* A, size_t rsa, size_t csa,
+                     const T* B, size_t rsb,
+                     T* C, size_t ldc, T alpha, T beta) {
+        row_acc even[R], odd[R];
+        for (size_t r = 0; r < R; ++r) {
+            even[r].zero();
+            odd[r].zero();
+        }
+        size_t p = 0;
+        for (; p + 2 <= k; p += 2) {
+            for (size_t r = 0; r < R; ++r) {
+                even[r].fma(A[r * rsa + p * csa], B + p * rsb);
+                odd[r].fma(A[r * rsa + (p + 1) * csa], B + (p + 1) * rsb);
+            }
+        }
+        if (p < k) {
+            for (size_t r = 0; r < R; ++r)
+                even[r].fma(A[r * rsa + p * csa], B + p * rsb);
+        }
+        for (size_t r = 0; r < R; ++r)
+            even[r].store(odd[r], C + r * ldc, alpha, beta);
+    }
+
+public:
+    // B rows must be contiguous (column stride 1).
+    static void run(size_t m, size_t k,
+                    const T* A, size_t rsa, size_t csa,
+                    const T* B, size_t rsb,
+                    T* C, size_t ldc, T alpha, T beta) {
+        // the tail runs a known m % 4 < 4 times, which lets GCC bound it
+        // when m is a constant (fixed_matrix)
+        const size_t body = m - m % 4;
+        for (size_t i = 0; i < body; i += 4)
+            rows<4>(k, A + i * rsa, rsa, csa, B, rsb, C + i * ldc, ldc, alpha, beta);
+        for (size_t t = 0; t < m % 4; ++t)
+            rows<1>(k, A + (body + t) * rsa, rsa, csa, B, rsb, C + (body + t) * ldc, ldc, alpha, beta);
+    }
+};
+
+constexpr size_t SMALL_GEMM_MAX_N = 16;
+
+template<typename T>
+using small_gemm_fn = void (*)(size_t, size_t, const T*, size_t, size_t,
+                               const T*, size_t, T*, size_t, T, T);
+
+// small_gemm_fixed<T, n>::run for 1 <= n <= SMALL_GEMM_MAX_N, else nullptr.
+template<typename T, size_t... I>
+small_gemm_fn<T> small_gemm_fixed_table(size_t n, std::index_sequence<I...>) {
+    static const small_gemm_fn<T> table[] = {&small_gemm_fixed<T, I + 1>::run...};
+    return n >= 1 && n <= sizeof...(I) ? table[n - 1] : nullptr;
+}
+
+template<typename T>
+small_gemm_fn<T> small_gemm_fixed_kernel(size_t n) {
+    return small_gemm_fixed_table<T>(n, std::make_index_sequence<SMALL_GEMM_MAX_N>());
+}
+
+// Level 1/2 kernels for products where one dimension is 1. They stream
+// each operand once with no packing and no zero-fill pass; unit-stride
+// operands use simd_reg loads, anything else falls back to scalar loops.
+// beta == 0 never reads the output.
+template<typename T>
+struct gemv_kernel {
+private:
+    using V = simd_reg<T>;
+    static constexpr size_t W = V::width;
+
+    static T scale(T y, T beta) {
+        return beta == 0 ? T(0) : beta * y;
+    }
+
+public:
+    // y = alpha * x + y
+    static void axpy(size_t n, T alpha, const T* x, size_t incx, T* y, size_t incy) {
+        size_t i = 0;
+        if (incx == 1 && incy == 1) {
+            const typename V::reg a = V::broadcast(alpha);
+            for (; i + 2 * W <= n; i += 2 * W) {
+                V::storeu(y + i, V::fmadd(a, V::loadu(x + i), V::loadu(y + i)));
+                V::storeu(y + i + W, V::fmadd(a, V::loadu(x + i + W), V::loadu(y + i + W)));
+            }
+            for (; i + W <= n; i += W)
+                V::storeu(y + i, V::fmadd(a, V::loadu(x + i), V::loadu(y + i)));
+        }
+        for (; i < n; ++i)
+            y[i * incy] += alpha * x[i * incx];
+    }
+
+    // sum of x[i] * y[i]
+    static T dot(size_t n, const T* x, size_t incx, const T* y, size_t incy) {
+        size_t i = 0;
+        T sum = 0;
+        if (incx == 1 && incy == 1) {
+            // four independent chains hide the FMA latency
+            typename V::reg acc0 = V::zero(), acc1 = V::zero(), acc2 = V::zero(), acc3 = V::zero();
+            for (; i + 4 * W <= n; i += 4 * W) {
+                acc0 = V::fmadd(V::loadu(x + i), V::loadu(y + i), acc0);
+                acc1 = V::fmadd(V::loadu(x + i + W), V::loadu(y + i + W), acc1);
+                acc2 = V::fmadd(V::loadu(x + i + 2 * W), V::loadu(y + i + 2 * W), acc2);
+                acc3 = V::fmadd(V::loadu(x + i + 3 * W), V::loadu(y + i + 3 * W), acc3);
+            }
+            for (; i + W <= n; i += W)
+                acc0 = V::fmadd(V::loadu(x + i), V::loadu(y + i), acc0);
+            T lanes[4][W];
+            V::storeu(lanes[0], acc0);
+            V::storeu(lanes[1], acc1);
+            V::storeu(lanes[2], acc2);
+            V::storeu(lanes[3], acc3);
+            for (size_t l = 0; l < W; ++l)
+                sum += (lanes[0][l] + lanes[1][l]) + (lanes[2][l] + lanes[3][l]);
+        }
+        for (; i < n; ++i)
+            sum += x[i * incx] * y[i * incy];
+        return sum;
+    }
+
+    // y = alpha * A * x + beta * y, A is m x n with strides (rsa, csa).
+    // Row-contiguous A is a dot product per row, column-contiguous A an axpy
+    // per column; both split the rows of y across threads when parallel.
+    static void gemv(size_t m, size_t n, const T* A, size_t rsa, size_t csa,
+                     const T* x, size_t incx, T* y, size_t incy,
+                     T alpha, T beta, bool parallel) {
+        const bool threaded = parallel && parallel_dispatch::use_parallel(parallel_op::elementwise, m * n);
+        if (csa == 1 || rsa != 1) {
+            #pragma omp parallel for schedule(static) if(threaded)
+            for (size_t i = 0; i < m; ++i) {
+                y[i * incy] = alpha * dot(n, A + i * rsa, csa, x, incx) + scale(y[i * incy], beta);
+            }
+            return;
+        }
+
+        // column-contiguous: each thread owns a slice of y and sweeps all columns over it
+        const size_t chunk = threaded ? std::max<size_t>(W * 64, (m + omp_get_max_threads() - 1) / omp_get_max_threads()) : m;
+        #pragma omp parallel for schedule(static) if(threaded)
+        for (size_t i0 = 0; i0 < m; i0 += chunk) {
+            const size_t len = std::min(chunk, m - i0);
+            T* ys = y + i0 * incy;
+            for (size_t i = 0; i < len; ++i)
+                ys[i * incy] = scale(ys[i * incy], beta);
+            for (size_t j = 0; j < n; ++j)
+                axpy(len, alpha * x[j * incx], A + i0 + j * csa, 1, ys, incy);
+        }
+    }
+
+    // C = alpha * x * y^T + beta * C, C is m x n row-major with leading dimension ldc.
+    static void ger(size_t m, size_t n, const T* x, size_t incx, const T* y, size_t incy,
+                    T* C, size_t ldc, T alpha, T beta, bool parallel) {
+        const bool threaded = parallel && parallel_dispatch::use_parallel(parallel_op::elementwise, m * n);
+        #pragma omp parallel for schedule(static) if(threaded)
+        for (size_t i = 0; i < m; ++i) {
+            T* c = C + i * ldc;
+            const T a = alpha * x[i * incx];
+            if (beta == 0) {
+                for (size_t j = 0; j < n; ++j)
+                    c[j] = a * y[j * incy];
+            } else {
+                if (beta != 1) {
+                    for (size_t j = 0; j < n; ++j)
+                        c[j] *= beta;
+                }
+                axpy(n, a, y, incy, c, 1);
+            }
+        }
+    }
+};
+
+// Computes C = alpha * op(A) * op(B) + beta * C.
+// Operands are addressed through row/col strides, so a transposed operand
+// is just a swapped pair of strides and never needs to be materialized.
+// C is row-major with leading dimension ldc. beta == 0 never reads C.
+//
+// The micro kernel issues MR * NV independent FMAs per loaded B vector, which
+// keeps the FMA pipes busy, and scales with the OpenMP thread count. The
+// fraction of peak reached on a given machine is what `make bench` reports
+// in the roof column of its gemm cases.
+template<typename T>
+class gemm_kernel {
+    static_assert(std::is_floating_point<T>::value, "T must be floating point type");
+private:
+    using V = simd_reg<T>;
+    using blk = gemm_blocking<T>;
+
+    static constexpr size_t MR = blk::MR;
+    static constexpr size_t NR = blk::NR;
+    static constexpr size_t NV = blk::NV;
+    static constexpr size_t W = blk::width;
+
+private:
+    static void micro_kernel(size_t kc, const T* a, const T* b,
+                             T* c, size_t ldc, T alpha, T beta) {
+        typename V::reg acc[MR][NV];
+        #pragma GCC unroll 16
+        for (size_t i = 0; i < MR; ++i)
+            #pragma GCC unroll 8
+            for (size_t j = 0; j < NV; ++j)
+                acc[i][j] = V::zero();
+
+        for (size_t p = 0; p < kc; ++p) {
+            typename V::reg bv[NV];
+            #pragma GCC unroll 8
+            for (size_t j = 0; j < NV; ++j)
+                bv[j] = V::load(b + p * NR + j * W);
+            #pragma GCC unroll 16
+            for (size_t i = 0; i < MR; ++i) {
+                const auto av = V::broadcast(a[p * MR + i]);
+                #pragma GCC unroll 8
+                for (size_t j = 0; j < NV; ++j)
+                    acc[i][j] = V::fmadd(av, bv[j], acc[i][j]);
+            }
+        }
+
+        const auto alpha_v = V::broadcast(alpha);
+        if (beta == 0) {
+            #pragma GCC unroll 16
+            for (size_t i = 0; i < MR; ++i)
+                #pragma GCC unroll 8
+                for (size_t j = 0; j < NV; ++j)
+                    V::storeu(c + i * ldc + j * W, V::mul(acc[i][j], alpha_v));
+        } else {
+            const auto beta_v = V::broadcast(beta);
+            #pragma GCC unroll 16
+            for (size_t i = 0; i < MR; ++i)
+                #pragma GCC unroll 8
+                for (size_t j = 0; j < NV; ++j) {
+                    T* cp = c + i * ldc + j * W;
+                    V::storeu(cp, V::fmadd(beta_v, V::loadu(cp), V::mul(acc[i][j], alpha_v)));
+                }
+        }
+    }
+
+    // Partial tiles on the right/bottom edge go through a local tile.
+    static void edge_kernel(size_t mr, size_t nr, size_t kc, const T* a, const T* b,
+                            T* c, size_t ldc, T alpha, T beta) {
+        alignas(64) T tile[MR * NR];
+        micro_kernel(kc, a, b, tile, NR, 1, 0);
+        for (size_t i = 0; i < mr; ++i)
+            for (size_t j = 0; j < nr; ++j) {
+                T& dst = c[i * ldc + j];
+                dst = beta == 0 ? alpha * tile[i * NR + j] : alpha * tile[i * NR + j] + beta * dst;
+            }
+    }
+
+    // A block (mc x kc) -> row panels of MR, column-major inside a panel.
+    static void pack_a(size_t mc, size_t kc, const T* A, size_t rsa, size_t csa, T* buf) {
+        for (size_t ir = 0; ir < mc; ir += MR) {
+            const size_t mr = std::min(MR, mc - ir);
+            T* dst = buf + ir * kc;
+            for (size_t p = 0; p < kc; ++p) {
+                const T* src = A + ir * rsa + p * csa;
+                size_t i = 0;
+                for (; i < mr; ++i)
+                    dst[p * MR + i] = src[i * rsa];
+                for (; i < MR; ++i)
+                    dst[p * MR + i] = 0;
+            }
+        }
+    }
+
+    // B block (kc x nc) -> column panels of NR, row-major inside a panel.
+    static void pack_b_panel(size_t nr, size_t kc, const T* B, size_t rsb, size_t csb, T* dst) {
+        if (nr == NR && csb == 1) {
+            for (size_t p = 0; p < kc; ++p)
+                std::memcpy(dst + p * NR, B + p * rsb, NR * sizeof(T));
+            return;
+        }
+        for (size_t p = 0; p < kc; ++p) {
+            size_t j = 0;
+            for (; j < nr; ++j)
+                dst[p * NR + j] = B[p * rsb + j * csb];
+            for (; j < NR; ++j)
+                dst[p * NR + j] = 0;
+        }
+    }
+
+    static void small_gemm(size_t m, size_t n, size_t k,
+                           const T* A, size_t rsa, size_t csa,
+                           const T* B, size_t rsb, size_t csb,
+                           T* C, size_t ldc, T alpha, T beta) {
+        const small_gemm_fn<T> fixed = csb == 1 ? small_gemm_fixed_kernel<T>(n) : nullptr;
+        if (fixed) {
+            fixed(m, k, A, rsa, csa, B, rsb, C, ldc, alpha, beta);
+            return;
+        }
+        for (size_t i = 0; i < m; ++i) {
+            T* c = C + i * ldc;
+            if (beta == 0) {
+                for (size_t j = 0; j < n; ++j)
+                    c[j] = 0;
+            } else if (beta != 1) {
+                for (size_t j = 0; j < n; ++j)
+                    c[j] *= beta;
+            }
+            for (size_t p = 0; p < k; ++p) {
+                const T a = alpha * A[i * rsa + p * csa];
+                const T* b = B + p * rsb;
+                if (csb == 1) {
+                    gemv_kernel<T>::axpy(n, a, b, 1, c, 1);
+                } else {
+                    for (size_t j = 0; j < n; ++j)
+                        c[j] += a * b[j * csb];
+                }
+            }
+        }
+    }
+
+public:
+    // Below this many multiply-adds packing costs more than it saves.
+    static constexpr size_t SMALL_GEMM_THRESHOLD = 32 * 32 * 32;
+
+    static void run(size_t m, size_t n, size_t k,
+                    const T* A, size_t rsa, size_t csa,
+                    const T* B, size_t rsb, size_t csb,
+                    T* C, size_t ldc, T alpha, T beta, bool parallel) {
+        if (!m || !n) {
+            return;
+        }
+        if (!k || alpha == 0) {
+            for (size_t i = 0; i < m; ++i)
+                for (size_t j = 0; j < n; ++j)
+                    C[i * ldc + j] = beta == 0 ? 0 : beta * C[i * ldc + j];
+            return;
+        }
+        // a dimension of 1 makes this a rank-1 update or a matrix-vector product
+        if (k == 1) {
+            gemv_kernel<T>::ger(m, n, A, rsa, B, csb, C, ldc, alpha, beta, parallel);
+            return;
+        }
+        if (n == 1) {
+            gemv_kernel<T>::gemv(m, k, A, rsa, csa, B, rsb, C, ldc, alpha, beta, parallel);
+            return;
+        }
+        if (m == 1) {
+            // C^T = op(B)^T * op(A)^T
+            gemv_kernel<T>::gemv(n, k, B, csb, rsb, A, csa, C, 1, alpha, beta, parallel);
+            return;
+        }
+        if (m * n * k <= SMALL_GEMM_THRESHOLD) {
+            small_gemm(m, n, k, A, rsa, csa, B, rsb, csb, C, ldc, alpha, beta);
+            return;
+        }
+
+        const int threads = parallel ? omp_get_max_threads() : 1;
+        const size_t kc_max = std::min(blk::KC, k);
+        const size_t nc_max = std::min(blk::NC, (n + NR - 1) / NR * NR);
+
+        // Shrink MC when there are fewer row blocks than threads.
+        size_t mc = blk::MC;
+        if (threads > 1) {
+            const size_t per_thread = (m + threads - 1) / threads;
+            mc = std::max(MR, std::min(mc, (per_thread + MR - 1) / MR * MR));
+        }
+
+        static thread_local aligned_buffer<T> b_buffer;
+        T* bpack = b_buffer.reserve(kc_max * nc_max);
+
+        for (size_t jc = 0; jc < n; jc += blk::NC) {
+            const size_t nc = std::min(blk::NC, n - jc);
+            const size_t n_panels = (nc + NR - 1) / NR;
+
+            for (size_t pc = 0; pc < k; pc += blk::KC) {
+                const size_t kc = std::min(blk::KC, k - pc);
+                const T beta_eff = pc == 0 ? beta : T(1);
+                const T* a_base = A + pc * csa;
+                const T* b_base = B + pc * rsb + jc * csb;
+                T* c_base = C + jc;
+
+                if (threads > 1) {
+                    MATRIX_PROFILE_PARALLEL_REGION();
+                }
+                #pragma omp parallel num_threads(threads) if(threads > 1)
+                {
+                    #pragma omp for schedule(static)
+                    for (size_t jp = 0; jp < n_panels; ++jp) {
+                        const size_t nr = std::min(NR, nc - jp * NR);
+                        pack_b_panel(nr, kc, b_base + jp * NR * csb, rsb, csb, bpack + jp * NR * kc);
+                    }
+
+                    static thread_local aligned_buffer<T> a_buffer;
+                    T* apack = a_buffer.reserve(((mc + MR - 1) / MR * MR) * kc_max);
+
+                    #pragma omp for schedule(dynamic)
+                    for (size_t ic = 0; ic < m; ic += mc) {
+                        const size_t mcb = std::min(mc, m - ic);
+                        pack_a(mcb, kc, a_base + ic * rsa, rsa, csa, apack);
+
+                        for (size_t jp = 0; jp < n_panels; ++jp) {
+                            const size_t nr = std::min(NR, nc - jp * NR);
+                            const T* bp = bpack + jp * NR * kc;
+                            for (size_t ir = 0; ir < mcb; ir += MR) {
+                                const size_t mr = std::min(MR, mcb - ir);
+                                T* cp = c_base + (ic + ir) * ldc + jp * NR;
+                                if (mr == MR && nr == NR) {
+                                    micro_kernel(kc, apack + ir * kc, bp, cp, ldc, alpha, beta_eff);
+                                } else {
+                                    edge_kernel(mr, nr, kc, apack + ir * kc, bp, cp, ldc, alpha, beta_eff);
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+};
+
+// Many independent products C[i] = alpha * A[i] * B[i] + beta * C[i] of the
+// same shape. Items are split across threads and each one runs serially, with
+// the unrolled kernel when n <= SMALL_GEMM_MAX_N and B has unit column
+// stride, and gemm_kernel otherwise. Strides follow gemm_kernel::run;
+// transposed operands are passed by swapping rs and cs.
+template<typename T>
+class gemm_batch {
+private:
+    template<typename Item>
+    static void for_each_item(size_t m, size_t n, size_t k, size_t csb, size_t batch, Item&& item) {
+        const small_gemm_fn<T> kernel = csb == 1 && m * n * k <= gemm_kernel<T>::SMALL_GEMM_THRESHOLD
+            ? small_gemm_fixed_kernel<T>(n)
+            : nullptr;
+        #pragma omp parallel for schedule(static) if(parallel_dispatch::use_parallel(parallel_op::elementwise, batch * m * n * k))
+        for (size_t b = 0; b < batch; ++b) {
+            item(b, kernel);
+        }
+    }
+
+public:
+    // Operands of item b start at A + b * stride_a, B + b * stride_b and
+    // C + b * stride_c. A stride of 0 shares one operand across the batch.
+    static void strided(size_t m, size_t n, size_t k,
+                        const T* A, size_t rsa, size_t csa, size_t stride_a,
+                        const T* B, size_t rsb, size_t csb, size_t stride_b,
+                        T* C, size_t ldc, size_t stride_c,
+                        size_t batch, T alpha, T beta) {
+        for_each_item(m, n, k, csb, batch, [&](size_t b, small_gemm_fn<T> kernel) {
+            const T* a = A + b * stride_a;
+            const T* bb = B + b * stride_b;
+            T* c = C + b * stride_c;
+            if (kernel) {
+                kernel(m, k, a, rsa, csa, bb, rsb, c, ldc, alpha, beta);
+            } else {
+                gemm_kernel<T>::run(m, n, k, a, rsa, csa, bb, rsb, csb, c, ldc, alpha, beta, false);
+            }
+        });
+    }
+
+    // Operands of item b are A[b], B[b] and C[b].
+    static void array(size_t m, size_t n, size_t k,
+                      const T* const* A, size_t rsa, size_t csa,
+                      const T* const* B, size_t rsb, size_t csb,
+                      T* const* C, size_t ldc,
+                      size_t batch, T alpha, T beta) {
+        for_each_item(m, n, k, csb, batch, [&](size_t b, small_gemm_fn<T> kernel) {
+            if (kernel) {
+                kernel(m, k, A[b], rsa, csa, B[b], rsb, C[b], ldc, alpha, beta);
+            } else {
+                gemm_kernel<T>::run(m, n, k, A[b], rsa, csa, B[b], rsb, csb, C[b], ldc, alpha, beta, false);
+            }
+        });
+    }
+};
@@ -0,0 +1,96 @@
+/* mapped_matrix.hpp - Zero-copy matrices backed by a memory-mapped file */
+/* by ValKmjolnir 2026/10/17 */
+
+#pragma once
+
+#include "file_mapping.hpp"
+#include "matrix.hpp"
+#include "matrix_io.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// A matrix whose elements are the pages of a file written by matrix::save,
+// so opening it costs one mmap() and no reads or copies; pages are faulted
+// in on first use. Every mapped_matrix of one file shares the mapping.
+//
+// Use view() in expressions and gemm(). mutable_view() is only available
+// for copy_on_write mappings. The file must hold T in the host byte order,
+// convert other files with matrix::load.
+template<typename T>
+class mapped_matrix {
+private:
+    std::shared_ptr<file_mapping> mapping;
+    T* num;
+    size_t row;
+    size_t col;
+
+    mapped_matrix(std::shared_ptr<file_mapping> m, T* p, size_t r, size_t c):
+        mapping(std::move(m)), num(p), row(r), col(c) {}
+
+    // records in file order, at most `limit` of them
+    static std::vector<mapped_matrix> records(const std::string& path, map_mode mode, size_t limit) {
+        auto mapping = std::make_shared<file_mapping>(path, mode);
+        std::vector<mapped_matrix> result;
+        size_t offset = 0;
+        while (offset < mapping->size() && result.size() < limit) {
+            char* base = mapping->data() + offset;
+            const size_t remain = mapping->size() - offset;
+            const matrix_record rec = parse_matrix_header<T>(base, remain);
+            if (rec.dtype != matrix_dtype<T>() || rec.swap_bytes) {
+                report_matrix_file("cannot map " + path + ", element type or byte order differs");
+            }
+            if (rec.data_offset > remain || rec.data_bytes() > remain - rec.data_offset) {
+                report_matrix_file("truncated matrix data in " + path);
+            }
+            char* data = base + rec.data_offset;
+            if (reinterpret_cast<uintptr_t>(data) % alignof(T)) {
+                report_matrix_file("misaligned matrix data in " + path);
+            }
+            result.push_back(mapped_matrix(mapping, reinterpret_cast<T*>(data), rec.rows, rec.cols));
+            offset += rec.data_offset + rec.data_bytes();
+        }
+        if (result.empty()) {
+            report_matrix_file("no matrix in " + path);
+        }
+        return result;
+    }
+
+public:
+    // the first matrix in path
+    explicit mapped_matrix(const std::string& path, map_mode mode = map_mode::read_only):
+        mapped_matrix(records(path, mode, 1).front()) {}
+
+    // every matrix in path, e.g. all the layers saved one after another
+    static std::vector<mapped_matrix> map_all(const std::string& path, map_mode mode = map_mode::read_only) {
+        return records(path, mode, static_cast<size_t>(-1));
+    }
+
+    size_t get_row() const { return row; }
+    size_t get_col() const { return col; }
+    const T* data() const { return num; }
+    map_mode get_mode() const { return mapping->get_mode(); }
+
+    const T* operator[](const size_t addr) const {
+        return addr >= row ? nullptr : &num[addr * col];
+    }
+
+    matrix_view<const T> view() const {
+        return matrix_view<const T>(num, row, col, col);
+    }
+
+    matrix_view<T> mutable_view() {
+        if (mapping->get_mode() != map_mode::copy_on_write) {
+            throw std::runtime_error("Error: mapped_matrix is read-only, map it with map_mode::copy_on_write to modify it.");
+        }
+        return matrix_view<T>(num, row, col, col);
+    }
+
+    matrix<T> to_matrix() const {
+        return matrix<T>(view());
+    }
+};
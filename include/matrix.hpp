@@ -2,9 +2,23 @@
 /* Rewrite    by ValKmjolnir 2022/11/16           */
 /* Update     by ValKmjolnir 2025/01/19           */
 /*            by ValKmjolnir 2026/01/22           */
+/*            by ValKmjolnir 2026/10/17           */
 
 #pragma once
 
+#include "gemm.hpp"
+#include "matrix_expr.hpp"
+#include "matrix_io.hpp"
+#include "matrix_pool.hpp"
+#include "matrix_view.hpp"
+#include "parallel.hpp"
+#include "profile.hpp"
+#include "random.hpp"
+#include "reduce.hpp"
+#include "softmax.hpp"
+#include "text_io.hpp"
+#include "transpose.hpp"
+
 #include <omp.h>
 
 #include <iostream>
@@ -14,15 +28,13 @@
 #include <cstdint>
 #include <cstdlib>
 #include <stdexcept>
-#include <random>
 #include <type_traits>
+#include <vector>
 
 template<typename T>
-class matrix {
+class matrix: public matrix_expr<T, matrix<T>> {
     static_assert(std::is_floating_point<T>::value, "T must be floating point type");
 private:
-    static constexpr size_t SMALL_MATRIX_THRESHOLD = 100;
-
     size_t row;
     size_t col;
     T* num;
@@ -43,16 +55,15 @@ private:
     }
 
     void copy_data(const T* source, T* destination, size_t size) {
-        if (size <= SMALL_MATRIX_THRESHOLD) {
-            for (size_t i = 0; i < size; ++i) {
-                destination[i] = source[i];
-            }
-        } else {
-            #pragma omp parallel for
-            for (size_t i = 0; i < size; ++i) {
-                destination[i] = source[i];
-            }
-        }
+        parallel_dispatch::for_each(parallel_op::copy, size, [=](size_t i) {
+            destination[i] = source[i];
+        });
+    }
+
+    // One fused pass over the whole expression tree.
+    template<typename E>
+    void assign_expr(const E& e) {
+        expr_apply(num, col, 1, e, assign_combine<T>());
     }
 
 public:
@@ -60,7 +71,7 @@ public:
         row = __row;
         col = __col;
         if (row > 0 && col > 0) {
-            num = new T [row * col];
+            num = matrix_pool::allocate_array<T>(row * col);
         } else {
             row = 0;
             col = 0;
@@ -70,10 +81,11 @@ public:
     }
 
     matrix(const matrix<T>& Temp) {
+        MATRIX_PROFILE_SCOPE("copy", 0, 2 * sizeof(T) * Temp.row * Temp.col);
         row = Temp.row;
         col = Temp.col;
         if (row > 0 && col > 0) {
-            num = new T [row * col];
+            num = matrix_pool::allocate_array<T>(row * col);
             copy_data(Temp.num, num, row * col);
         } else {
             row = 0;
@@ -93,9 +105,15 @@ public:
         Temp.num = nullptr;
     }
 
+    template<typename E, typename = std::enable_if_t<!is_matrix<E>::value>>
+    matrix(const matrix_expr<T, E>& expr): matrix(expr.self().get_row(), expr.self().get_col()) {
+        MATRIX_PROFILE_SCOPE("expr", 0, sizeof(T) * row * col);
+        assign_expr(expr.self());
+    }
+
     ~matrix() {
         if (num) {
-            delete[] num;
+            matrix_pool::deallocate_array(num, row * col);
         }
         return;
     }
@@ -109,29 +127,15 @@ public:
         return col;
     }
 
-public:
-    matrix operator+(const matrix<T>& B) const {
-        if (this->row != B.row || this->col != B.col) {
-            report("+", B);
-        }
-        matrix<T> Temp(this->row, this->col);
-        #pragma omp parallel for
-        for (size_t i = 0; i < row * col; ++i)
-            Temp.num[i] = this->num[i] + B.num[i];
-        return Temp;
+    T* data() {
+        return num;
     }
 
-    matrix operator-(const matrix<T>& B) const {
-        if (this->row != B.row || this->col != B.col) {
-            report("-", B);
-        }
-        matrix<T> Temp(this->row, this->col);
-        #pragma omp parallel for
-        for (size_t i = 0; i < row * col; ++i)
-            Temp.num[i] = this->num[i] - B.num[i];
-        return Temp;
+    const T* data() const {
+        return num;
     }
 
+public:
     matrix operator*(const matrix<T>& B) const {
         if (!this->row || !this->col || !B.row || !B.col) {
             report_zero_size("*");
@@ -139,32 +143,12 @@ public:
             report("*", B);
         }
 
+        MATRIX_PROFILE_SCOPE("gemm", 2.0 * row * col * B.col, sizeof(T) * (row * col + B.row * B.col + row * B.col));
         matrix<T> Temp(this->row, B.col);
-        #pragma omp parallel for
-        for (size_t idx = 0; idx < Temp.row * Temp.col; ++idx)
-            Temp.num[idx] = 0;
-
-        const size_t BLOCK = 64;
-        #pragma omp parallel for collapse(2)
-        for (size_t ii = 0; ii < Temp.row; ii += BLOCK)
-            for (size_t jj = 0; jj < Temp.col; jj += BLOCK)
-                for (size_t kk = 0; kk < this->col; kk += BLOCK) {
-                    const size_t i_end = std::min(ii + BLOCK, Temp.row);
-                    const size_t j_end = std::min(jj + BLOCK, Temp.col);
-                    const size_t k_end = std::min(kk + BLOCK, this->col);
-
-                    for (size_t i = ii; i < i_end; ++i) {
-                        const size_t tbase = i * Temp.col;
-                        const size_t abase = i * this->col;
-                        for (size_t k = kk; k < k_end; ++k) {
-                            const T a = this->num[abase + k];
-                            const size_t bbase = k * B.col;
-                            for (size_t j = jj; j < j_end; ++j) {
-                                Temp.num[tbase + j] += a * B.num[bbase + j];
-                            }
-                        }
-                    }
-                }
+        gemm_kernel<T>::run(this->row, B.col, this->col,
+                            this->num, this->col, 1,
+                            B.num, B.col, 1,
+                            Temp.num, Temp.col, 1, 0, true);
         return Temp;
     }
 
@@ -172,15 +156,24 @@ public:
         if (this == &B) {
             return *this; // self-assignment check
         }
+        MATRIX_PROFILE_SCOPE("copy", 0, 2 * sizeof(T) * B.row * B.col);
+
+        // same element count, reuse the buffer
+        if (num && row * col == B.row * B.col) {
+            row = B.row;
+            col = B.col;
+            copy_data(B.num, num, row * col);
+            return *this;
+        }
 
         if (num) {
-            delete[] num;
+            matrix_pool::deallocate_array(num, row * col);
         }
 
         row = B.row;
         col = B.col;
         if (row > 0 && col > 0) {
-            num = new T [row * col];
+            num = matrix_pool::allocate_array<T>(row * col);
             copy_data(B.num, num, row * col);
         } else {
             row = 0;
@@ -197,7 +190,7 @@ public:
         }
 
         if (num) {
-            delete[] num;
+            matrix_pool::deallocate_array(num, row * col);
         }
 
         row = B.row;
@@ -210,37 +203,57 @@ public:
         return *this;
     }
 
-    matrix& operator+=(const matrix<T>& B) {
-        if (this->row != B.row || this->col != B.col) {
-            report("+=", B);
+    template<typename E, typename = std::enable_if_t<!is_matrix<E>::value>>
+    matrix& operator=(const matrix_expr<T, E>& expr) {
+        const E& e = expr.self();
+        MATRIX_PROFILE_SCOPE("expr", 0, sizeof(T) * e.get_row() * e.get_col());
+        if (row == e.get_row() && col == e.get_col()) {
+            assign_expr(e);
+            return *this;
         }
-        #pragma omp parallel for
-        for (size_t i = 0; i < row * col; ++i)
-            num[i] += B.num[i];
+        // shape changes, the old buffer may still be read by the expression
+        matrix<T> Temp(e.get_row(), e.get_col());
+        Temp.assign_expr(e);
+        return *this = std::move(Temp);
+    }
+
+    template<typename E>
+    matrix& operator+=(const matrix_expr<T, E>& expr) {
+        const auto& e = expr_leaf(expr);
+        if (this->row != e.get_row() || this->col != e.get_col()) {
+            report_expr_mismatch("+=", row, col, e.get_row(), e.get_col());
+        }
+        MATRIX_PROFILE_SCOPE("+=", row * col, 2 * sizeof(T) * row * col);
+        expr_apply(num, col, 1, e, add_op<T>());
         return *this;
     }
 
-    matrix& operator-=(const matrix<T>& B) {
-        if (this->row != B.row || this->col != B.col) {
-            report("-=", B);
+    template<typename E>
+    matrix& operator-=(const matrix_expr<T, E>& expr) {
+        const auto& e = expr_leaf(expr);
+        if (this->row != e.get_row() || this->col != e.get_col()) {
+            report_expr_mismatch("-=", row, col, e.get_row(), e.get_col());
         }
-        #pragma omp parallel for
-        for (size_t i = 0; i < row * col; ++i)
-            num[i] -= B.num[i];
+        MATRIX_PROFILE_SCOPE("-=", row * col, 2 * sizeof(T) * row * col);
+        expr_apply(num, col, 1, e, sub_op<T>());
         return *this;
     }
 
     matrix& operator*=(const T B) {
-        #pragma omp parallel for
-        for (size_t i = 0; i < row * col; ++i)
-            num[i] *= B;
+        MATRIX_PROFILE_SCOPE("*=", row * col, 2 * sizeof(T) * row * col);
+        T* dst = num;
+        parallel_dispatch::for_each(parallel_op::elementwise, row * col, [=](size_t i) {
+            dst[i] *= B;
+        });
         return *this;
     }
 
     matrix& operator/=(const T B) {
-        #pragma omp parallel for
-        for (size_t i = 0; i < row * col; ++i)
-            num[i] /= B;
+        MATRIX_PROFILE_SCOPE("/=", row * col, 2 * sizeof(T) * row * col);
+        T* dst = num;
+        parallel_dispatch::for_each(parallel_op::elementwise, row * col, [=](size_t i) {
+            dst[i] /= B;
+        });
         return *this;
     }
 
@@ -254,37 +267,92 @@ public:
     }
 
 public:
-    T sum() const {
-        T sum = 0;
-        #pragma omp parallel for reduction(+:sum)
-        for (size_t i = 0; i < row * col; ++i)
-            sum += num[i];
-        return sum;
+    matrix_view<T> view() {
+        return matrix_view<T>(num, row, col, col);
     }
 
-    matrix hadamard(const matrix<T>& B) const {
-        if (!this->row || !this->col || !B.row || !B.col) {
-            report_zero_size("hadamard");
-        } else if (this->row != B.row || this->col != B.col) {
-            report("hadamard", B);
-        }
+    matrix_view<const T> view() const {
+        return matrix_view<const T>(num, row, col, col);
+    }
 
-        matrix<T> temp(this->row, this->col);
-        #pragma omp parallel for
-        for (size_t i = 0; i < this->row * this->col; ++i)
-            temp.num[i] = this->num[i] * B.num[i];
-        return temp;
+    matrix_view<T> row_view(const size_t r) {
+        return view().row_view(r);
+    }
+
+    matrix_view<const T> row_view(const size_t r) const {
+        return view().row_view(r);
+    }
+
+    matrix_view<T> col_view(const size_t c) {
+        return view().col_view(c);
+    }
+
+    matrix_view<const T> col_view(const size_t c) const {
+        return view().col_view(c);
+    }
+
+    matrix_view<T> block(const size_t r, const size_t c, const size_t rows, const size_t cols) {
+        return view().block(r, c, rows, cols);
+    }
+
+    matrix_view<const T> block(const size_t r, const size_t c, const size_t rows, const size_t cols) const {
+        return view().block(r, c, rows, cols);
+    }
+
+public:
+    using matrix_expr<T, matrix<T>>::sum;
+
+    T sum() const {
+        const T* src = num;
+        return reduce_kernel<T>::sum(row * col, [=](size_t i) {
+            return src[i];
+        });
     }
 
     matrix transpose() const {
+        MATRIX_PROFILE_SCOPE("transpose", 0, 2 * sizeof(T) * row * col);
         matrix<T> temp(this->col, this->row);
-        #pragma omp parallel for collapse(2)
-        for (size_t i = 0; i < this->row; ++i)
-            for (size_t j = 0; j < this->col; ++j)
-                temp.num[j * this->row + i] = this->num[i * this->col + j];
+        transpose_kernel<T>::run(row, col, num, col, temp.num, row);
         return temp;
     }
 
+    // Transposes without allocating a second matrix. Square matrices swap
+    // tiles across the diagonal, rectangular ones follow permutation cycles.
+    matrix& transpose_inplace() {
+        MATRIX_PROFILE_SCOPE("transpose_inplace", 0, 2 * sizeof(T) * row * col);
+        if (row == col) {
+            transpose_kernel<T>::square_inplace(row, num);
+        } else {
+            transpose_kernel<T>::rect_inplace(row, col, num);
+            std::swap(row, col);
+        }
+        return *this;
+    }
+
+    // this = alpha * op(A) * op(B) + beta * this, op(X) is X or X^T.
+    // Transposed operands are read through strides, nothing is copied.
+    // With beta == 0 the destination is resized if needed, otherwise
+    // its shape must already match.
+    matrix& gemm(const matrix_view<const T> A, const matrix_view<const T> B,
+                 const T alpha = 1, const T beta = 0,
+                 const bool transA = false, const bool transB = false) {
+        const auto shape = gemm_shape(A, B, transA, transB);
+        const size_t k = transA ? A.get_row() : A.get_col();
+        MATRIX_PROFILE_SCOPE("gemm", 2.0 * shape.first * shape.second * k,
+                             sizeof(T) * (shape.first * k + k * shape.second + shape.first * shape.second));
+        if (row != shape.first || col != shape.second) {
+            if (beta != 0) {
+                report_expr_mismatch("gemm", shape.first, shape.second, row, col);
+            }
+            // A or B may view the old buffer, release it only afterwards
+            matrix<T> Temp(shape.first, shape.second);
+            ::gemm<T>(Temp.view(), A, B, alpha, 0, transA, transB);
+            return *this = std::move(Temp);
+        }
+        ::gemm<T>(view(), A, B, alpha, beta, transA, transB);
+        return *this;
+    }
+
     matrix mult_sequential(const matrix<T>& B) const {
         if (!this->row || !this->col || !B.row || !B.col) {
             report_zero_size("*");
@@ -292,133 +360,76 @@ public:
             report("*", B);
         }
 
+        MATRIX_PROFILE_SCOPE("gemm_sequential", 2.0 * row * col * B.col, sizeof(T) * (row * col + B.row * B.col + row * B.col));
         matrix<T> Temp(this->row, B.col);
-        for (size_t idx = 0; idx < Temp.row * Temp.col; ++idx)
-            Temp.num[idx] = 0;
-
-        const size_t BLOCK = 64;
-        for (size_t ii = 0; ii < Temp.row; ii += BLOCK)
-            for (size_t jj = 0; jj < Temp.col; jj += BLOCK)
-                for (size_t kk = 0; kk < this->col; kk += BLOCK) {
-                    const size_t i_end = std::min(ii + BLOCK, Temp.row);
-                    const size_t j_end = std::min(jj + BLOCK, Temp.col);
-                    const size_t k_end = std::min(kk + BLOCK, this->col);
-
-                    for (size_t i = ii; i < i_end; ++i) {
-                        const size_t tbase = i * Temp.col;
-                        const size_t abase = i * this->col;
-                        for (size_t k = kk; k < k_end; ++k) {
-                            const T a = this->num[abase + k];
-                            const size_t bbase = k * B.col;
-                            for (size_t j = jj; j < j_end; ++j) {
-                                Temp.num[tbase + j] += a * B.num[bbase + j];
-                            }
-                        }
-                    }
-                }
+        gemm_kernel<T>::run(this->row, B.col, this->col,
+                            this->num, this->col, 1,
+                            B.num, B.col, 1,
+                            Temp.num, Temp.col, 1, 0, false);
         return Temp;
     }
 
 public:
-    void random_init() {
-        static thread_local std::random_device rd;
-        static thread_local std::mt19937 gen(rd());
-        static thread_local std::uniform_real_distribution<T> dis(-1.0, 1.0);
-
-        for (size_t i = 0; i < row * col; ++i)
-            num[i] = dis(gen);
-    }
-
-public:
-    template<typename _T>
-    friend std::ostream& operator<<(std::ostream& out, const matrix<_T>& m) {
-        static_assert(std::is_floating_point<_T>::value, "_T must be floating point type");
-        for (size_t i = 0; i < m.row; ++i)
-            for (size_t j = 0; j < m.col; ++j)
-                out << m.num[i * m.col + j] << ((char)(j == m.col - 1)? '\n' : ' ');
-        return out;
-    }
-
-    template<typename _T>
-    friend std::istream& operator>>(std::istream& in, matrix<_T>& m) {
-        static_assert(std::is_floating_point<_T>::value, "_T must be floating point type");
-        for (size_t i = 0; i < m.row; ++i)
-            for (size_t j = 0; j < m.col; ++j)
-                in >> m.num[i * m.col + j];
-        return in;
+    // Random fills, see random.hpp. The same seed gives the same matrix
+    // whatever the thread count; without a seed random_config picks one.
+    void random_init(const uint64_t seed = random_config::next_seed()) {
+        MATRIX_PROFILE_SCOPE("random_uniform", 0, sizeof(T) * row * col);
+        random_kernel<T>::uniform(row * col, num, -1, 1, seed);
     }
 
-public:
-    matrix sigmoid() const {
-        matrix<T> temp(this->row, this->col);
-        #pragma omp parallel for
-        for (size_t i = 0; i < this->row * this->col; ++i)
-            temp.num[i] = 1 / (1 + std::exp(-this->num[i]));
-        return temp;
+    void random_uniform(const T lo, const T hi, const uint64_t seed = random_config::next_seed()) {
+        MATRIX_PROFILE_SCOPE("random_uniform", 0, sizeof(T) * row * col);
+        random_kernel<T>::uniform(row * col, num, lo, hi, seed);
     }
 
-    matrix sigmoid_derivative() const {
-        matrix<T> temp(this->row, this->col);
-        #pragma omp parallel for
-        for (size_t i = 0; i < this->row * this->col; ++i)
-            temp.num[i] = this->num[i] * (1 - this->num[i]);
-        return temp;
+    void random_normal(const T mean, const T stddev, const uint64_t seed = random_config::next_seed()) {
+        MATRIX_PROFILE_SCOPE("random_normal", 0, sizeof(T) * row * col);
+        random_kernel<T>::normal(row * col, num, mean, stddev, seed);
     }
 
-    matrix tanh() const {
-        matrix<T> temp(this->row, this->col);
-        #pragma omp parallel for
-        for (size_t i = 0; i < this->row * this->col; ++i)
-            temp.num[i] = std::tanh(this->num[i]);
-        return temp;
+    // Weights used as x * W, fan_in = row and fan_out = col.
+    // Xavier/Glorot: uniform in +-sqrt(6 / (fan_in + fan_out)).
+    void xavier_init(const uint64_t seed = random_config::next_seed()) {
+        MATRIX_PROFILE_SCOPE("random_uniform", 0, sizeof(T) * row * col);
+        const T limit = std::sqrt(static_cast<T>(6) / static_cast<T>(row + col));
+        random_kernel<T>::uniform(row * col, num, -limit, limit, seed);
     }
 
-    matrix tanh_derivative() const {
-        matrix<T> temp(this->row, this->col);
-        #pragma omp parallel for
-        for (size_t i = 0; i < this->row * this->col; ++i)
-            temp.num[i] = 1 - std::pow(this->num[i], 2);
-        return temp;
+    // He/Kaiming: normal with stddev sqrt(2 / fan_in), for ReLU layers.
+    void he_init(const uint64_t seed = random_config::next_seed()) {
+        MATRIX_PROFILE_SCOPE("random_normal", 0, sizeof(T) * row * col);
+        random_kernel<T>::normal(row * col, num, 0, std::sqrt(static_cast<T>(2) / static_cast<T>(row)), seed);
     }
 
-    matrix relu() const {
-        matrix<T> temp(this->row, this->col);
-        #pragma omp parallel for
-        for (size_t i = 0; i < this->row * this->col; ++i)
-            temp.num[i] = this->num[i] > 0 ? this->num[i] : 0;
-        return temp;
+public:
+    // Shortest round-trip text, see text_io.hpp. Stream precision and
+    // format flags do not apply.
+    friend std::ostream& operator<<(std::ostream& out, const matrix<T>& m) {
+        MATRIX_PROFILE_SCOPE("text_write", 0, sizeof(T) * m.row * m.col);
+        text_codec<T>::write(out, m.num, m.row, m.col);
+        return out;
     }
 
-    matrix relu_derivative() const {
-        matrix<T> temp(this->row, this->col);
-        #pragma omp parallel for
-        for (size_t i = 0; i < this->row * this->col; ++i)
-            temp.num[i] = this->num[i] > 0 ? 1 : 0;
-        return temp;
+    // Fills m with row * col numbers separated by whitespace or commas.
+    // Missing numbers or a token that is not a number set failbit, like
+    // reading the numbers one by one would; load_text() throws instead.
+    friend std::istream& operator>>(std::istream& in, matrix<T>& m) {
+        MATRIX_PROFILE_SCOPE("text_read", 0, sizeof(T) * m.row * m.col);
+        try {
+            if (text_codec<T>::read(in, m.num, m.row * m.col) < m.row * m.col) {
+                in.setstate(std::ios::failbit);
+            }
+        } catch (const std::runtime_error&) {
+            in.setstate(std::ios::failbit);
+        }
+        return in;
     }
 
+public:
     matrix softmax() const {
+        MATRIX_PROFILE_SCOPE("softmax", 0, 2 * sizeof(T) * row * col);
         matrix<T> temp(this->row, this->col);
-        for (size_t i = 0; i < this->row; ++i) {
-            T max_val = this->num[i * this->col];  // find max value of each line
-            for (size_t j = 1; j < this->col; ++j) {
-                if (this->num[i * this->col + j] > max_val) {
-                    max_val = this->num[i * this->col + j];
-                }
-            }
-
-            T sum = 0;
-            #pragma omp parallel for reduction(+:sum)
-            for (size_t j = 0; j < this->col; ++j) {
-                T exp_val = std::exp(this->num[i * this->col + j] - max_val);
-                sum += exp_val;
-                temp.num[i * temp.col + j] = exp_val;
-            }
-
-            #pragma omp parallel for
-            for (size_t j = 0; j < this->col; ++j)
-                temp.num[i * temp.col + j] /= sum;
-        }
+        softmax_kernel<T>::run(row, col, num, temp.num);
         return temp;
     }
 
@@ -426,60 +437,169 @@ public:
         if (this->row != label.row || this->col != label.col) {
             report("matrix size mismatch", label);
         }
-        // this->num must be softmax output (not raw logits)
-        matrix<T> temp(this->row, this->col);
-        #pragma omp parallel for
-        for (size_t i = 0; i < this->row * this->col; ++i) {
-            temp.num[i] = this->num[i] - label.num[i];
-        }
-        return temp;
-    }
-
-    matrix pow(const T B) const {
-        matrix<T> temp(this->row, this->col);
-        #pragma omp parallel for
-        for (size_t i = 0; i < this->row * this->col; ++i)
-            temp.num[i] = std::pow(this->num[i], B);
-        return temp;
+        // this->num must be softmax output (not raw logits),
+        // softmax_cross_entropy() below does both steps in one pass
+        return matrix<T>(*this - label);
     }
 
     matrix l1_normalize() const {
-        T sum = 0;
-        #pragma omp parallel for reduction(+:sum)
-        for (size_t i = 0; i < this->row * this->col; ++i)
-            sum += std::abs(this->num[i]);
-        matrix<T> temp(this->row, this->col);
-        #pragma omp parallel for
-        for (size_t i = 0; i < this->row * this->col; ++i)
-            temp.num[i] = this->num[i]/sum;
-        return temp;
+        MATRIX_PROFILE_SCOPE("l1_normalize", 3 * row * col, 3 * sizeof(T) * row * col);
+        const T* src = num;
+        const T sum = reduce_kernel<T>::sum(row * col, [=](size_t i) {
+            return std::abs(src[i]);
+        });
+        return matrix<T>(*this / sum);
     }
 
     matrix l2_normalize() const {
-        T sum = 0;
-        #pragma omp parallel for reduction(+:sum)
-        for (size_t i = 0; i < this->row * this->col; ++i)
-            sum += std::pow(this->num[i], 2);
-        sum = std::sqrt(sum);
-        matrix<T> temp(this->row, this->col);
-        #pragma omp parallel for
-        for (size_t i = 0; i < this->row* this->col; ++i)
-            temp.num[i] = this->num[i]/sum;
-        return temp;
+        MATRIX_PROFILE_SCOPE("l2_normalize", 4 * row * col, 4 * sizeof(T) * row * col);
+        const T* src = num;
+        const T norm = reduce_kernel<T>::norm2(row * col, [=](size_t i) {
+            return src[i];
+        });
+        return matrix<T>(*this / norm);
     }
 
+    // One record of the format in matrix_io.hpp.
     void save(std::ostream& out) const {
-        out.write((char*)&this->row, sizeof(size_t));
-        out.write((char*)&this->col, sizeof(size_t));
-        out.write((char*)this->num, sizeof(T) * this->row * this->col);
+        MATRIX_PROFILE_SCOPE("save", 0, sizeof(T) * row * col);
+        write_matrix(out, num, row, col);
     }
 
+    // Reads straight into the current buffer when the element count
+    // matches. Files of the other floating point type or byte order are
+    // converted, files from before the header are still accepted.
     void load(std::istream& in) {
-        in.read((char*)&this->row, sizeof(size_t));
-        in.read((char*)&this->col, sizeof(size_t));
+        MATRIX_PROFILE_SCOPE("load", 0, sizeof(T) * row * col);
+        const matrix_record rec = read_matrix_header<T>(in);
+        if (rec.rows * rec.cols != row * col || !num) {
+            *this = matrix<T>(rec.rows, rec.cols);
+        } else {
+            row = rec.rows;
+            col = rec.cols;
+        }
+        read_matrix_data(in, rec, num);
+    }
 
-        auto tmp = matrix<T>(this->row, this->col);
-        in.read((char*)tmp.num, sizeof(T) * this->row * this->col);
-        *this = tmp;
+    // One row per line, sep = ',' writes CSV.
+    void save_text(std::ostream& out, const char sep = ' ') const {
+        MATRIX_PROFILE_SCOPE("text_write", 0, sizeof(T) * row * col);
+        text_codec<T>::write(out, num, row, col, sep);
     }
-};
\ No newline at end of file
+
+    // Reads the rest of the stream as a text matrix, the shape comes from
+    // the text: one row per non-empty line.
+    void load_text(std::istream& in) {
+        MATRIX_PROFILE_SCOPE("text_read", 0, 0);
+        text_codec<T>::read_all(in, [this](size_t rows, size_t cols) {
+            if (rows * cols != row * col || !num) {
+                *this = matrix<T>(rows, cols);
+            } else {
+                row = rows;
+                col = cols;
+            }
+            return num;
+        });
+    }
+};
+
+template<typename T>
+struct softmax_cross_entropy_result {
+    T loss;              // summed over rows
+    matrix<T> gradient;  // softmax(logits) - labels
+};
+
+// Loss and gradient of softmax + cross-entropy from raw logits, without
+// materializing the softmax output.
+template<typename T>
+softmax_cross_entropy_result<T> softmax_cross_entropy(const matrix<T>& logits, const matrix<T>& labels) {
+    if (logits.get_row() != labels.get_row() || logits.get_col() != labels.get_col()) {
+        report_expr_mismatch("softmax_cross_entropy", logits.get_row(), logits.get_col(),
+                             labels.get_row(), labels.get_col());
+    }
+    MATRIX_PROFILE_SCOPE("softmax_cross_entropy", 0, 3 * sizeof(T) * logits.get_row() * logits.get_col());
+    matrix<T> gradient(logits.get_row(), logits.get_col());
+    const T loss = softmax_kernel<T>::cross_entropy(logits.get_row(), logits.get_col(),
+                                                    logits.data(), labels.data(), gradient.data());
+    return {loss, std::move(gradient)};
+}
+
+// Shared body of the gemm_batched overloads, b_at(i) gives the i-th B.
+template<typename T, typename GetB>
+void gemm_batched_items(std::vector<matrix<T>>& C, const std::vector<matrix<T>>& A,
+                        GetB&& b_at, size_t b_count,
+                        T alpha, T beta, bool transA, bool transB) {
+    const size_t batch = A.size();
+    if (b_count != batch || (beta != 0 && C.size() != batch)) {
+        std::ostringstream oss;
+        oss << "Error: batch size not match! In calculation gemm_batched: A has " << batch
+            << " items, B has " << b_count << ", C has " << C.size() << ".";
+        throw std::runtime_error(oss.str());
+    }
+    if (!batch) {
+        return;
+    }
+
+    const matrix<T>& B0 = b_at(0);
+    const auto shape = gemm_shape<T>(A[0], B0, transA, transB);
+    const size_t m = shape.first;
+    const size_t n = shape.second;
+    const size_t k = transA ? A[0].get_row() : A[0].get_col();
+    MATRIX_PROFILE_SCOPE("gemm_batched", 2.0 * batch * m * n * k, sizeof(T) * batch * (m * k + k * n + m * n));
+    if (C.size() != batch) {
+        // items already in C keep their storage, a wrong shape is replaced below
+        C.resize(batch, matrix<T>(m, n));
+    }
+
+    static thread_local std::vector<const T*> a_ptr, b_ptr;
+    static thread_local std::vector<T*> c_ptr;
+    a_ptr.resize(batch);
+    b_ptr.resize(batch);
+    c_ptr.resize(batch);
+    for (size_t i = 0; i < batch; ++i) {
+        const matrix<T>& Bi = b_at(i);
+        if (A[i].get_row() != A[0].get_row() || A[i].get_col() != A[0].get_col()) {
+            report_expr_mismatch("gemm_batched", A[0].get_row(), A[0].get_col(), A[i].get_row(), A[i].get_col());
+        }
+        if (Bi.get_row() != B0.get_row() || Bi.get_col() != B0.get_col()) {
+            report_expr_mismatch("gemm_batched", B0.get_row(), B0.get_col(), Bi.get_row(), Bi.get_col());
+        }
+        if (C[i].get_row() != m || C[i].get_col() != n) {
+            if (beta != 0) {
+                report_expr_mismatch("gemm_batched", m, n, C[i].get_row(), C[i].get_col());
+            }
+            C[i] = matrix<T>(m, n);
+        }
+        a_ptr[i] = A[i].data();
+        b_ptr[i] = Bi.data();
+        c_ptr[i] = C[i].data();
+    }
+
+    const size_t lda = A[0].get_col();
+    const size_t ldb = B0.get_col();
+    gemm_batch<T>::array(m, n, k,
+                         a_ptr.data(), transA ? 1 : lda, transA ? lda : 1,
+                         b_ptr.data(), transB ? 1 : ldb, transB ? ldb : 1,
+                         c_ptr.data(), n, batch, alpha, beta);
+}
+
+// C[i] = alpha * op(A[i]) * op(B[i]) + beta * C[i] for every i, one thread
+// per group of items. All A (and all B) must have the same shape. With
+// beta == 0 C is resized to the batch and each item to the result shape.
+// C must not share storage with A or B.
+template<typename T>
+void gemm_batched(std::vector<matrix<T>>& C, const std::vector<matrix<T>>& A, const std::vector<matrix<T>>& B,
+                  const T alpha = 1, const T beta = 0,
+                  const bool transA = false, const bool transB = false) {
+    gemm_batched_items(C, A, [&](size_t i) -> const matrix<T>& { return B[i]; }, B.size(),
+                       alpha, beta, transA, transB);
+}
+
+// Same with one B shared by every item, e.g. a weight matrix.
+template<typename T>
+void gemm_batched(std::vector<matrix<T>>& C, const std::vector<matrix<T>>& A, const matrix<T>& B,
+                  const T alpha = 1, const T beta = 0,
+                  const bool transA = false, const bool transB = false) {
+    gemm_batched_items(C, A, [&](size_t) -> const matrix<T>& { return B; }, A.size(),
+                       alpha, beta, transA, transB);
+}
@@ -0,0 +1,730 @@
+/* matrix_expr.hpp - Lazy elementwise expressions for matrix.hpp */
+/* by ValKmjolnir 2026/10/17 */
+
+#pragma once
+
+#include "axis_reduce.hpp"
+#include "parallel.hpp"
+#include "profile.hpp"
+#include "reduce.hpp"
+#include "simd_math.hpp"
+
+#include <omp.h>
+
+#include <iostream>
+#include <cmath>
+#include <sstream>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+template<typename T>
+class matrix;
+
+template<typename T>
+class matrix_view;
+
+struct matrix_expr_tag {};
+
+template<typename X>
+struct is_matrix : std::false_type {};
+
+template<typename T>
+struct is_matrix<matrix<T>> : std::true_type {};
+
+template<typename X>
+constexpr bool is_matrix_v = is_matrix<std::decay_t<X>>::value;
+
+template<typename X>
+constexpr bool is_matrix_expr_v = std::is_base_of<matrix_expr_tag, std::decay_t<X>>::value;
+
+inline void report_expr_mismatch(const char* calc,
+                                 size_t row, size_t col,
+                                 size_t other_row, size_t other_col) {
+    std::ostringstream oss;
+    oss << "Error: matrix size not match! In calculation " << calc
+        << ": expect (" << row << " x " << col << "), but get ("
+        << other_row << " x " << other_col << ").";
+    throw std::runtime_error(oss.str());
+}
+
+// The elements expr_apply writes, element (r, c) at base[r * rs + c * cs]
+// and all of them inside [begin, end). Below a broadcast base is null: every
+// overlap counts, since one leaf element feeds many destination elements.
+template<typename T>
+struct expr_target {
+    const T* begin;
+    const T* end;
+    const T* base;
+    size_t rs;
+    size_t cs;
+};
+
+// True when a leaf over num (rows x cols, strides rs and cs) overlaps the
+// target and reads element (r, c) from anywhere but target element (r, c).
+template<typename T>
+bool expr_leaf_aliases(const T* num, size_t rows, size_t cols, size_t rs, size_t cs,
+                       const expr_target<T>& t) {
+    if (!rows || !cols) {
+        return false;
+    }
+    const T* end = num + (rows - 1) * rs + (cols - 1) * cs + 1;
+    if (end <= t.begin || t.end <= num) {
+        return false;
+    }
+    return num != t.base || (rows > 1 && rs != t.rs) || (cols > 1 && cs != t.cs);
+}
+
+// Leaf referring to an lvalue matrix. The matrix must outlive the expression,
+// same as any reference: `auto e = a + b;` is fine while a and b are alive.
+template<typename T>
+class matrix_ref {
+private:
+    const T* num;
+    size_t row;
+    size_t col;
+
+public:
+    static constexpr bool transcendental = false;
+
+    explicit matrix_ref(const matrix<T>& m): num(m.data()), row(m.get_row()), col(m.get_col()) {}
+
+    size_t get_row() const { return row; }
+    size_t get_col() const { return col; }
+    bool contiguous() const { return true; }
+    bool aliases(const expr_target<T>& t) const { return expr_leaf_aliases(num, row, col, col, size_t(1), t); }
+    template<typename M>
+    T element(size_t i, M) const { return num[i]; }
+    template<typename M>
+    T element(size_t r, size_t c, M) const { return num[r * col + c]; }
+};
+
+// Leaf owning a temporary matrix, e.g. the result of operator*.
+template<typename T>
+class matrix_owner {
+private:
+    matrix<T> m;
+
+public:
+    static constexpr bool transcendental = false;
+
+    explicit matrix_owner(matrix<T>&& temp): m(std::move(temp)) {}
+
+    size_t get_row() const { return m.get_row(); }
+    size_t get_col() const { return m.get_col(); }
+    bool contiguous() const { return true; }
+    bool aliases(const expr_target<T>&) const { return false; }
+    template<typename M>
+    T element(size_t i, M) const { return m.data()[i]; }
+    template<typename M>
+    T element(size_t r, size_t c, M) const { return m.data()[r * m.get_col() + c]; }
+};
+
+// Lvalue matrices are referenced, rvalue matrices are moved in and
+// expression nodes are stored by value.
+template<typename X>
+auto make_operand(X&& x) {
+    using D = std::decay_t<X>;
+    if constexpr (is_matrix<D>::value) {
+        using T = typename D::value_type;
+        if constexpr (std::is_lvalue_reference<X>::value) {
+            return matrix_ref<T>(x);
+        } else {
+            return matrix_owner<T>(std::move(x));
+        }
+    } else {
+        return D(std::forward<X>(x));
+    }
+}
+
+template<typename X>
+using operand_t = decltype(make_operand(std::declval<X>()));
+
+template<typename T, typename Op, typename E>
+class unary_expr;
+
+template<typename T, typename Op, typename L, typename R>
+class binary_expr;
+
+template<typename T, typename E, bool Rows>
+class broadcast_expr;
+
+// Transcendental ops take a math_fast/math_exact tag picked per evaluation,
+// see simd_math.hpp.
+template<typename T>
+struct sigmoid_op {
+    static constexpr bool transcendental = true;
+    template<typename M>
+    T operator()(T x, M m) const { return math_sigmoid(x, m); }
+};
+
+template<typename T>
+struct sigmoid_derivative_op {
+    static constexpr bool transcendental = false;
+    T operator()(T x) const { return x * (1 - x); }
+};
+
+template<typename T>
+struct tanh_op {
+    static constexpr bool transcendental = true;
+    template<typename M>
+    T operator()(T x, M m) const { return math_tanh(x, m); }
+};
+
+template<typename T>
+struct tanh_derivative_op {
+    static constexpr bool transcendental = false;
+    T operator()(T x) const { return 1 - x * x; }
+};
+
+template<typename T>
+struct relu_op {
+    static constexpr bool transcendental = false;
+    T operator()(T x) const { return x > 0 ? x : 0; }
+};
+
+template<typename T>
+struct relu_derivative_op {
+    static constexpr bool transcendental = false;
+    T operator()(T x) const { return x > 0 ? 1 : 0; }
+};
+
+template<typename T>
+struct pow_op {
+    static constexpr bool transcendental = true;
+    T p;
+    template<typename M>
+    T operator()(T x, M) const { return p == 2 ? x * x : std::pow(x, p); }
+};
+
+template<typename T>
+struct negate_op {
+    static constexpr bool transcendental = false;
+    T operator()(T x) const { return -x; }
+};
+
+template<typename T>
+struct scalar_add_op {
+    static constexpr bool transcendental = false;
+    T s;
+    T operator()(T x) const { return x + s; }
+};
+
+template<typename T>
+struct scalar_sub_op {
+    static constexpr bool transcendental = false;
+    T s;
+    T operator()(T x) const { return s - x; }
+};
+
+template<typename T>
+struct scalar_mul_op {
+    static constexpr bool transcendental = false;
+    T s;
+    T operator()(T x) const { return x * s; }
+};
+
+template<typename T>
+struct scalar_div_op {
+    static constexpr bool transcendental = false;
+    T s;
+    T operator()(T x) const { return x / s; }
+};
+
+template<typename T>
+struct add_op {
+    static constexpr bool transcendental = false;
+    T operator()(T a, T b) const { return a + b; }
+};
+
+template<typename T>
+struct sub_op {
+    static constexpr bool transcendental = false;
+    T operator()(T a, T b) const { return a - b; }
+};
+
+template<typename T>
+struct mul_op {
+    static constexpr bool transcendental = false;
+    T operator()(T a, T b) const { return a * b; }
+};
+
+template<typename X, typename Op>
+auto make_unary(X&& x, Op op) {
+    using T = typename std::decay_t<X>::value_type;
+    return unary_expr<T, Op, operand_t<X>>(make_operand(std::forward<X>(x)), op);
+}
+
+template<typename Op, typename L, typename R>
+auto make_binary(L&& l, R&& r, const char* calc) {
+    using T = typename std::decay_t<L>::value_type;
+    static_assert(std::is_same<T, typename std::decay_t<R>::value_type>::value,
+                  "operands must have the same element type");
+    return binary_expr<T, Op, operand_t<L>, operand_t<R>>(
+        make_operand(std::forward<L>(l)), make_operand(std::forward<R>(r)), calc);
+}
+
+// v (1 x cols) repeated down `rows` rows, without copying it.
+template<typename X>
+auto broadcast_row(X&& v, size_t rows, const char* calc = "broadcast_row") {
+    using T = typename std::decay_t<X>::value_type;
+    return broadcast_expr<T, operand_t<X>, true>(make_operand(std::forward<X>(v)), rows, calc);
+}
+
+// v (rows x 1) repeated across `cols` columns, without copying it.
+template<typename X>
+auto broadcast_col(X&& v, size_t cols, const char* calc = "broadcast_col") {
+    using T = typename std::decay_t<X>::value_type;
+    return broadcast_expr<T, operand_t<X>, false>(make_operand(std::forward<X>(v)), cols, calc);
+}
+
+// Calls f with the math tag for evaluating E. Expressions without
+// transcendental ops always use math_fast, it is never looked at.
+template<typename E, typename F>
+decltype(auto) expr_with_math(F&& f) {
+    if constexpr (E::transcendental) {
+        return with_math_mode(std::forward<F>(f));
+    } else {
+        return f(math_fast());
+    }
+}
+
+// Base of matrix<T>, matrix_view<T> and of every lazy node. Elementwise
+// methods return nodes that are evaluated in one fused loop when assigned.
+// Nodes provide get_row(), get_col(), element(r, c, m), and element(i, m)
+// over the flat index, which is only used while contiguous() is true.
+// m is math_fast or math_exact. aliases(t) checks the leaves against the
+// destination of an assignment, see expr_apply.
+template<typename T, typename E>
+class matrix_expr: public matrix_expr_tag {
+public:
+    using value_type = T;
+
+    const E& self() const { return static_cast<const E&>(*this); }
+    E&& moved() { return static_cast<E&&>(*this); }
+
+public:
+    auto sigmoid() const& { return make_unary(self(), sigmoid_op<T>()); }
+    auto sigmoid() && { return make_unary(moved(), sigmoid_op<T>()); }
+
+    auto sigmoid_derivative() const& { return make_unary(self(), sigmoid_derivative_op<T>()); }
+    auto sigmoid_derivative() && { return make_unary(moved(), sigmoid_derivative_op<T>()); }
+
+    auto tanh() const& { return make_unary(self(), tanh_op<T>()); }
+    auto tanh() && { return make_unary(moved(), tanh_op<T>()); }
+
+    auto tanh_derivative() const& { return make_unary(self(), tanh_derivative_op<T>()); }
+    auto tanh_derivative() && { return make_unary(moved(), tanh_derivative_op<T>()); }
+
+    auto relu() const& { return make_unary(self(), relu_op<T>()); }
+    auto relu() && { return make_unary(moved(), relu_op<T>()); }
+
+    auto relu_derivative() const& { return make_unary(self(), relu_derivative_op<T>()); }
+    auto relu_derivative() && { return make_unary(moved(), relu_derivative_op<T>()); }
+
+    auto pow(const T B) const& { return make_unary(self(), pow_op<T>{B}); }
+    auto pow(const T B) && { return make_unary(moved(), pow_op<T>{B}); }
+
+    template<typename R>
+    auto hadamard(R&& B) const& {
+        return make_binary<mul_op<T>>(self(), std::forward<R>(B), "hadamard");
+    }
+
+    template<typename R>
+    auto hadamard(R&& B) && {
+        return make_binary<mul_op<T>>(moved(), std::forward<R>(B), "hadamard");
+    }
+
+    // Row vector v (1 x cols) applied to every row, or column vector v
+    // (rows x 1) applied to every column, e.g. `(X * W).add_row(bias)`.
+    template<typename R>
+    auto add_row(R&& v) const& {
+        return make_binary<add_op<T>>(self(), broadcast_row(std::forward<R>(v), self().get_row(), "add_row"), "add_row");
+    }
+
+    template<typename R>
+    auto add_row(R&& v) && {
+        return make_binary<add_op<T>>(moved(), broadcast_row(std::forward<R>(v), self().get_row(), "add_row"), "add_row");
+    }
+
+    template<typename R>
+    auto sub_row(R&& v) const& {
+        return make_binary<sub_op<T>>(self(), broadcast_row(std::forward<R>(v), self().get_row(), "sub_row"), "sub_row");
+    }
+
+    template<typename R>
+    auto sub_row(R&& v) && {
+        return make_binary<sub_op<T>>(moved(), broadcast_row(std::forward<R>(v), self().get_row(), "sub_row"), "sub_row");
+    }
+
+    template<typename R>
+    auto mul_row(R&& v) const& {
+        return make_binary<mul_op<T>>(self(), broadcast_row(std::forward<R>(v), self().get_row(), "mul_row"), "mul_row");
+    }
+
+    template<typename R>
+    auto mul_row(R&& v) && {
+        return make_binary<mul_op<T>>(moved(), broadcast_row(std::forward<R>(v), self().get_row(), "mul_row"), "mul_row");
+    }
+
+    template<typename R>
+    auto add_col(R&& v) const& {
+        return make_binary<add_op<T>>(self(), broadcast_col(std::forward<R>(v), self().get_col(), "add_col"), "add_col");
+    }
+
+    template<typename R>
+    auto add_col(R&& v) && {
+        return make_binary<add_op<T>>(moved(), broadcast_col(std::forward<R>(v), self().get_col(), "add_col"), "add_col");
+    }
+
+    template<typename R>
+    auto sub_col(R&& v) const& {
+        return make_binary<sub_op<T>>(self(), broadcast_col(std::forward<R>(v), self().get_col(), "sub_col"), "sub_col");
+    }
+
+    template<typename R>
+    auto sub_col(R&& v) && {
+        return make_binary<sub_op<T>>(moved(), broadcast_col(std::forward<R>(v), self().get_col(), "sub_col"), "sub_col");
+    }
+
+    template<typename R>
+    auto mul_col(R&& v) const& {
+        return make_binary<mul_op<T>>(self(), broadcast_col(std::forward<R>(v), self().get_col(), "mul_col"), "mul_col");
+    }
+
+    template<typename R>
+    auto mul_col(R&& v) && {
+        return make_binary<mul_op<T>>(moved(), broadcast_col(std::forward<R>(v), self().get_col(), "mul_col"), "mul_col");
+    }
+
+private:
+    template<typename Op>
+    matrix<T> reduce(reduce_axis axis, Op op, const char* calc) const {
+        const auto& e = expr_leaf(*this);
+        using L = std::decay_t<decltype(e)>;
+        const size_t rows = e.get_row();
+        const size_t cols = e.get_col();
+        if (!rows || !cols) {
+            std::ostringstream oss;
+            oss << "Error: matrix size is zero! (" << calc << ")";
+            throw std::runtime_error(oss.str());
+        }
+        MATRIX_PROFILE_SCOPE(calc, rows * cols, sizeof(T) * rows * cols);
+        matrix<T> result(axis == reduce_axis::rows ? 1 : rows, axis == reduce_axis::rows ? cols : 1);
+        expr_with_math<L>([&](auto m) {
+            auto f = [&](size_t r, size_t c) { return e.element(r, c, m); };
+            if (axis == reduce_axis::rows) {
+                axis_reduce_kernel<T>::over_rows(rows, cols, f, op, result.data());
+            } else {
+                axis_reduce_kernel<T>::over_cols(rows, cols, f, op, result.data());
+            }
+        });
+        return result;
+    }
+
+public:
+    T sum() const {
+        const E& e = self();
+        return expr_with_math<E>([&](auto m) {
+            if (!e.contiguous()) {
+                return reduce_kernel<T>::sum_2d(e.get_row(), e.get_col(),
+                                                [&](size_t r, size_t c) { return e.element(r, c, m); });
+            }
+            return reduce_kernel<T>::sum(e.get_row() * e.get_col(), [&](size_t i) {
+                return e.element(i, m);
+            });
+        });
+    }
+
+    // Reductions along one axis, 1 x cols for reduce_axis::rows and
+    // rows x 1 for reduce_axis::cols. See axis_reduce.hpp.
+    matrix<T> sum(reduce_axis axis) const {
+        return reduce(axis, reduce_sum<T>(), "sum");
+    }
+
+    matrix<T> max(reduce_axis axis) const {
+        return reduce(axis, reduce_max<T>(), "max");
+    }
+
+    matrix<T> min(reduce_axis axis) const {
+        return reduce(axis, reduce_min<T>(), "min");
+    }
+
+    matrix<T> mean(reduce_axis axis) const {
+        matrix<T> result = reduce(axis, reduce_sum<T>(), "mean");
+        result /= static_cast<T>(axis == reduce_axis::rows ? self().get_row() : self().get_col());
+        return result;
+    }
+
+    // Index of the first largest element of each column (reduce_axis::rows)
+    // or of each row (reduce_axis::cols).
+    std::vector<size_t> argmax(reduce_axis axis) const {
+        const auto& e = expr_leaf(*this);
+        using L = std::decay_t<decltype(e)>;
+        const size_t rows = e.get_row();
+        const size_t cols = e.get_col();
+        std::vector<size_t> index(axis == reduce_axis::rows ? cols : rows);
+        expr_with_math<L>([&](auto m) {
+            auto f = [&](size_t r, size_t c) { return e.element(r, c, m); };
+            if (axis == reduce_axis::rows) {
+                axis_reduce_kernel<T>::argmax_over_rows(rows, cols, f, index.data());
+            } else {
+                axis_reduce_kernel<T>::argmax_over_cols(rows, cols, f, index.data());
+            }
+        });
+        return index;
+    }
+
+    matrix<T> eval() const {
+        return matrix<T>(self());
+    }
+};
+
+// Expressions containing exp/tanh/pow go parallel at a smaller size.
+template<typename E>
+constexpr parallel_op expr_parallel_op() {
+    return E::transcendental ? parallel_op::transcendental : parallel_op::elementwise;
+}
+
+// Something with element(i) for an expression without copying it.
+template<typename T, typename E>
+decltype(auto) expr_leaf(const matrix_expr<T, E>& expr) {
+    if constexpr (is_matrix<E>::value) {
+        return matrix_ref<T>(expr.self());
+    } else {
+        return expr.self();
+    }
+}
+
+template<typename T>
+struct assign_combine {
+    T operator()(T, T v) const { return v; }
+};
+
+// dst(r, c) = combine(dst(r, c), e(r, c)), dst(r, c) lives at dst[r * rs + c * cs].
+// Elementwise nodes read only element (r, c) of their operands, so the
+// destination may appear in the tree addressed with the same strides. Any
+// other overlap, such as a transposed view of dst or a row of dst under a
+// broadcast, is evaluated into a temporary first.
+template<typename T, typename E, typename Combine>
+void expr_apply(T* dst, size_t rs, size_t cs, const E& e, Combine combine) {
+    const size_t rows = e.get_row();
+    const size_t cols = e.get_col();
+    if (rows && cols &&
+        e.aliases(expr_target<T>{dst, dst + (rows - 1) * rs + (cols - 1) * cs + 1, dst, rs, cs})) {
+        matrix<T> temp(rows, cols);
+        expr_apply(temp.data(), cols, 1, e, assign_combine<T>());
+        expr_apply(dst, rs, cs, matrix_ref<T>(temp), combine);
+        return;
+    }
+    expr_with_math<E>([&](auto m) {
+        if (cs == 1 && (rs == cols || rows <= 1) && e.contiguous()) {
+            parallel_dispatch::for_each(expr_parallel_op<E>(), rows * cols, [&](size_t i) {
+                dst[i] = combine(dst[i], e.element(i, m));
+            });
+        } else {
+            parallel_dispatch::for_each_2d(expr_parallel_op<E>(), rows, cols, [&](size_t r, size_t c) {
+                T& d = dst[r * rs + c * cs];
+                d = combine(d, e.element(r, c, m));
+            });
+        }
+    });
+}
+
+template<typename T, typename Op, typename E>
+class unary_expr: public matrix_expr<T, unary_expr<T, Op, E>> {
+private:
+    E operand;
+    Op op;
+
+public:
+    static constexpr bool transcendental = Op::transcendental || E::transcendental;
+
+    unary_expr(E&& e, Op o): operand(std::move(e)), op(o) {}
+
+private:
+    template<typename M>
+    T apply(T x, M m) const {
+        if constexpr (Op::transcendental) {
+            return op(x, m);
+        } else {
+            return op(x);
+        }
+    }
+
+public:
+
+    size_t get_row() const { return operand.get_row(); }
+    size_t get_col() const { return operand.get_col(); }
+    bool contiguous() const { return operand.contiguous(); }
+    bool aliases(const expr_target<T>& t) const { return operand.aliases(t); }
+    template<typename M>
+    T element(size_t i, M m) const { return apply(operand.element(i, m), m); }
+    template<typename M>
+    T element(size_t r, size_t c, M m) const { return apply(operand.element(r, c, m), m); }
+};
+
+template<typename T, typename Op, typename L, typename R>
+class binary_expr: public matrix_expr<T, binary_expr<T, Op, L, R>> {
+private:
+    L lhs;
+    R rhs;
+    Op op;
+
+public:
+    static constexpr bool transcendental = L::transcendental || R::transcendental;
+
+    binary_expr(L&& l, R&& r, const char* calc): lhs(std::move(l)), rhs(std::move(r)) {
+        if (lhs.get_row() != rhs.get_row() || lhs.get_col() != rhs.get_col()) {
+            report_expr_mismatch(calc, lhs.get_row(), lhs.get_col(), rhs.get_row(), rhs.get_col());
+        }
+    }
+
+    size_t get_row() const { return lhs.get_row(); }
+    size_t get_col() const { return lhs.get_col(); }
+    bool contiguous() const { return lhs.contiguous() && rhs.contiguous(); }
+    bool aliases(const expr_target<T>& t) const { return lhs.aliases(t) || rhs.aliases(t); }
+    template<typename M>
+    T element(size_t i, M m) const { return op(lhs.element(i, m), rhs.element(i, m)); }
+    template<typename M>
+    T element(size_t r, size_t c, M m) const { return op(lhs.element(r, c, m), rhs.element(r, c, m)); }
+};
+
+// A row vector repeated down the rows (Rows) or a column vector repeated
+// across the columns of a larger expression. Not contiguous, so evaluation
+// goes through element(r, c), which reads the operand at row or column 0.
+template<typename T, typename E, bool Rows>
+class broadcast_expr: public matrix_expr<T, broadcast_expr<T, E, Rows>> {
+private:
+    E operand;
+    size_t count;
+
+public:
+    static constexpr bool transcendental = E::transcendental;
+
+    broadcast_expr(E&& e, size_t n, const char* calc): operand(std::move(e)), count(n) {
+        if (Rows && operand.get_row() != 1) {
+            report_expr_mismatch(calc, 1, operand.get_col(), operand.get_row(), operand.get_col());
+        }
+        if (!Rows && operand.get_col() != 1) {
+            report_expr_mismatch(calc, operand.get_row(), 1, operand.get_row(), operand.get_col());
+        }
+    }
+
+    size_t get_row() const { return Rows ? count : operand.get_row(); }
+    size_t get_col() const { return Rows ? operand.get_col() : count; }
+    bool contiguous() const { return false; }
+    bool aliases(const expr_target<T>& t) const {
+        return operand.aliases(expr_target<T>{t.begin, t.end, nullptr, 0, 0});
+    }
+    template<typename M>
+    T element(size_t i, M m) const { return element(i / get_col(), i % get_col(), m); }
+    template<typename M>
+    T element(size_t r, size_t c, M m) const {
+        return Rows ? operand.element(0, c, m) : operand.element(r, 0, m);
+    }
+};
+
+template<typename L, typename R,
+         typename = std::enable_if_t<is_matrix_expr_v<L> && is_matrix_expr_v<R>>>
+auto operator+(L&& l, R&& r) {
+    using T = typename std::decay_t<L>::value_type;
+    return make_binary<add_op<T>>(std::forward<L>(l), std::forward<R>(r), "+");
+}
+
+template<typename L, typename R,
+         typename = std::enable_if_t<is_matrix_expr_v<L> && is_matrix_expr_v<R>>>
+auto operator-(L&& l, R&& r) {
+    using T = typename std::decay_t<L>::value_type;
+    return make_binary<sub_op<T>>(std::forward<L>(l), std::forward<R>(r), "-");
+}
+
+template<typename L, typename = std::enable_if_t<is_matrix_expr_v<L>>>
+auto operator-(L&& l) {
+    using T = typename std::decay_t<L>::value_type;
+    return make_unary(std::forward<L>(l), negate_op<T>());
+}
+
+template<typename L, typename S,
+         typename = std::enable_if_t<is_matrix_expr_v<L> && std::is_arithmetic<S>::value>>
+auto operator+(L&& l, const S s) {
+    using T = typename std::decay_t<L>::value_type;
+    return make_unary(std::forward<L>(l), scalar_add_op<T>{static_cast<T>(s)});
+}
+
+template<typename S, typename R,
+         typename = std::enable_if_t<std::is_arithmetic<S>::value && is_matrix_expr_v<R>>>
+auto operator+(const S s, R&& r) {
+    using T = typename std::decay_t<R>::value_type;
+    return make_unary(std::forward<R>(r), scalar_add_op<T>{static_cast<T>(s)});
+}
+
+template<typename L, typename S,
+         typename = std::enable_if_t<is_matrix_expr_v<L> && std::is_arithmetic<S>::value>>
+auto operator-(L&& l, const S s) {
+    using T = typename std::decay_t<L>::value_type;
+    return make_unary(std::forward<L>(l), scalar_add_op<T>{-static_cast<T>(s)});
+}
+
+template<typename S, typename R,
+         typename = std::enable_if_t<std::is_arithmetic<S>::value && is_matrix_expr_v<R>>>
+auto operator-(const S s, R&& r) {
+    using T = typename std::decay_t<R>::value_type;
+    return make_unary(std::forward<R>(r), scalar_sub_op<T>{static_cast<T>(s)});
+}
+
+template<typename L, typename S,
+         typename = std::enable_if_t<is_matrix_expr_v<L> && std::is_arithmetic<S>::value>>
+auto operator*(L&& l, const S s) {
+    using T = typename std::decay_t<L>::value_type;
+    return make_unary(std::forward<L>(l), scalar_mul_op<T>{static_cast<T>(s)});
+}
+
+template<typename S, typename R,
+         typename = std::enable_if_t<std::is_arithmetic<S>::value && is_matrix_expr_v<R>>>
+auto operator*(const S s, R&& r) {
+    using T = typename std::decay_t<R>::value_type;
+    return make_unary(std::forward<R>(r), scalar_mul_op<T>{static_cast<T>(s)});
+}
+
+template<typename L, typename S,
+         typename = std::enable_if_t<is_matrix_expr_v<L> && std::is_arithmetic<S>::value>>
+auto operator/(L&& l, const S s) {
+    using T = typename std::decay_t<L>::value_type;
+    return make_unary(std::forward<L>(l), scalar_div_op<T>{static_cast<T>(s)});
+}
+
+template<typename X>
+struct is_matrix_view : std::false_type {};
+
+template<typename T>
+struct is_matrix_view<matrix_view<T>> : std::true_type {};
+
+// Operands gemm can read in place through strides.
+template<typename X>
+constexpr bool is_strided_v = is_matrix<std::decay_t<X>>::value || is_matrix_view<std::decay_t<X>>::value;
+
+// Matrix product involving views or lazy operands. Views are multiplied in
+// place, lazy operands are evaluated first.
+template<typename L, typename R,
+         typename = std::enable_if_t<is_matrix_expr_v<L> && is_matrix_expr_v<R> &&
+                                     !(is_matrix_v<L> && is_matrix_v<R>)>>
+auto operator*(const L& l, const R& r) {
+    using T = typename std::decay_t<L>::value_type;
+    if constexpr (!is_strided_v<L>) {
+        return matrix<T>(l) * r;
+    } else if constexpr (!is_strided_v<R>) {
+        return l * matrix<T>(r);
+    } else {
+        matrix<T> result(0, 0);
+        result.gemm(l, r);
+        return result;
+    }
+}
+
+template<typename T, typename E,
+         typename = std::enable_if_t<!is_matrix<E>::value>>
+std::ostream& operator<<(std::ostream& out, const matrix_expr<T, E>& e) {
+    return out << matrix<T>(e);
+}
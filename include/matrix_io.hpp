@@ -0,0 +1,224 @@
+/* matrix_io.hpp - Versioned binary matrix format used by matrix.hpp */
+/* by ValKmjolnir 2026/10/17 */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// One matrix record, fields in the byte order of the writer:
+//
+//   offset  size  field
+//   0       4     magic "MTRX"
+//   4       2     version, MATRIX_FILE_VERSION
+//   6       1     dtype: 1 float, 2 double, 3 long double (host format)
+//   7       1     byte order: 1 little endian, 2 big endian
+//   8       4     data offset, bytes from the start of the record to the data
+//   12      4     zero
+//   16      8     rows
+//   24      8     cols
+//   32            zero padding up to the data offset
+//                 rows * cols elements, row-major
+//
+// The padding puts the data at a multiple of MATRIX_FILE_ALIGN bytes from
+// the start of the stream, so a mapped file can be used in place. Several
+// records can follow each other in one file.
+//
+// Files written before the header existed start with rows and cols as raw
+// size_t followed by the data; they are still read.
+constexpr uint16_t MATRIX_FILE_VERSION = 1;
+constexpr size_t MATRIX_FILE_ALIGN = 64;
+constexpr size_t MATRIX_FILE_HEADER_SIZE = 32;
+
+template<typename T>
+constexpr uint8_t matrix_dtype() {
+    return std::is_same<T, float>::value ? 1 : std::is_same<T, double>::value ? 2 : 3;
+}
+
+inline size_t matrix_dtype_size(uint8_t dtype) {
+    switch (dtype) {
+        case 1: return sizeof(float);
+        case 2: return sizeof(double);
+        case 3: return sizeof(long double);
+        default: return 0;
+    }
+}
+
+inline uint8_t host_byte_order() {
+    const uint16_t probe = 1;
+    uint8_t first;
+    std::memcpy(&first, &probe, 1);
+    return first ? 1 : 2;
+}
+
+// What a record header says about the data that follows it.
+struct matrix_record {
+    uint8_t dtype;
+    bool swap_bytes;    // written with the other byte order
+    size_t rows;
+    size_t cols;
+    size_t data_offset; // from the start of the record
+
+    size_t data_bytes() const { return rows * cols * matrix_dtype_size(dtype); }
+};
+
+inline void report_matrix_file(const std::string& what) {
+    throw std::runtime_error("Error: " + what);
+}
+
+// Rejects shapes whose byte size does not fit in size_t, either as stored
+// or once converted to T, so data_bytes() and rows * cols never wrap.
+template<typename T>
+void check_matrix_record(const matrix_record& rec) {
+    const size_t element = std::max(matrix_dtype_size(rec.dtype), sizeof(T));
+    if (rec.rows && rec.cols > SIZE_MAX / rec.rows / element) {
+        report_matrix_file("corrupted matrix header");
+    }
+}
+
+// Parses a record header from the first `size` bytes at p. Legacy records
+// are assumed to hold T.
+template<typename T>
+matrix_record parse_matrix_header(const char* p, size_t size) {
+    matrix_record rec{matrix_dtype<T>(), false, 0, 0, 0};
+    if (size >= 4 && std::memcmp(p, "MTRX", 4) == 0) {
+        if (size < MATRIX_FILE_HEADER_SIZE) {
+            report_matrix_file("truncated matrix header");
+        }
+        rec.swap_bytes = static_cast<uint8_t>(p[7]) != host_byte_order();
+        uint16_t version;
+        uint32_t offset;
+        uint64_t rows, cols;
+        std::memcpy(&version, p + 4, sizeof(version));
+        std::memcpy(&offset, p + 8, sizeof(offset));
+        std::memcpy(&rows, p + 16, sizeof(rows));
+        std::memcpy(&cols, p + 24, sizeof(cols));
+        if (rec.swap_bytes) {
+            std::reverse(reinterpret_cast<char*>(&version), reinterpret_cast<char*>(&version) + sizeof(version));
+            std::reverse(reinterpret_cast<char*>(&offset), reinterpret_cast<char*>(&offset) + sizeof(offset));
+            std::reverse(reinterpret_cast<char*>(&rows), reinterpret_cast<char*>(&rows) + sizeof(rows));
+            std::reverse(reinterpret_cast<char*>(&cols), reinterpret_cast<char*>(&cols) + sizeof(cols));
+        }
+        if (version > MATRIX_FILE_VERSION) {
+            std::ostringstream oss;
+            oss << "unsupported matrix file version " << version << ", expect at most " << MATRIX_FILE_VERSION;
+            report_matrix_file(oss.str());
+        }
+        rec.dtype = static_cast<uint8_t>(p[6]);
+        if (!matrix_dtype_size(rec.dtype) || offset < MATRIX_FILE_HEADER_SIZE) {
+            report_matrix_file("corrupted matrix header");
+        }
+        rec.rows = rows;
+        rec.cols = cols;
+        rec.data_offset = offset;
+        check_matrix_record<T>(rec);
+        return rec;
+    }
+
+    if (size < 2 * sizeof(size_t)) {
+        report_matrix_file("truncated matrix header");
+    }
+    std::memcpy(&rec.rows, p, sizeof(size_t));
+    std::memcpy(&rec.cols, p + sizeof(size_t), sizeof(size_t));
+    rec.data_offset = 2 * sizeof(size_t);
+    check_matrix_record<T>(rec);
+    return rec;
+}
+
+// Writes a record header and its padding, the rows * cols elements of T
+// are expected to follow.
+template<typename T>
+void write_matrix_header(std::ostream& out, size_t rows, size_t cols) {
+    const std::streamoff pos = out.tellp();
+    const size_t start = pos < 0 ? 0 : static_cast<size_t>(pos);
+    const size_t data_start = (start + MATRIX_FILE_HEADER_SIZE + MATRIX_FILE_ALIGN - 1) / MATRIX_FILE_ALIGN * MATRIX_FILE_ALIGN;
+
+    char header[MATRIX_FILE_HEADER_SIZE] = {};
+    const uint16_t version = MATRIX_FILE_VERSION;
+    const uint32_t offset = static_cast<uint32_t>(data_start - start);
+    const uint64_t r = rows, c = cols;
+    std::memcpy(header, "MTRX", 4);
+    std::memcpy(header + 4, &version, sizeof(version));
+    header[6] = static_cast<char>(matrix_dtype<T>());
+    header[7] = static_cast<char>(host_byte_order());
+    std::memcpy(header + 8, &offset, sizeof(offset));
+    std::memcpy(header + 16, &r, sizeof(r));
+    std::memcpy(header + 24, &c, sizeof(c));
+    out.write(header, MATRIX_FILE_HEADER_SIZE);
+
+    const char padding[MATRIX_FILE_ALIGN] = {};
+    out.write(padding, offset - MATRIX_FILE_HEADER_SIZE);
+}
+
+template<typename T>
+void write_matrix(std::ostream& out, const T* data, size_t rows, size_t cols) {
+    write_matrix_header<T>(out, rows, cols);
+    out.write(reinterpret_cast<const char*>(data), sizeof(T) * rows * cols);
+}
+
+// Reads a record header and leaves the stream at the first element.
+template<typename T>
+matrix_record read_matrix_header(std::istream& in) {
+    char header[MATRIX_FILE_HEADER_SIZE];
+    in.read(header, 4);
+    if (in && std::memcmp(header, "MTRX", 4) == 0) {
+        in.read(header + 4, MATRIX_FILE_HEADER_SIZE - 4);
+        const size_t got = in ? MATRIX_FILE_HEADER_SIZE : 4 + static_cast<size_t>(in.gcount());
+        const matrix_record rec = parse_matrix_header<T>(header, got);
+        in.ignore(rec.data_offset - MATRIX_FILE_HEADER_SIZE);
+        if (!in) {
+            report_matrix_file("truncated matrix header");
+        }
+        return rec;
+    }
+    in.read(header + 4, 2 * sizeof(size_t) - 4);
+    if (!in) {
+        report_matrix_file("truncated matrix header");
+    }
+    return parse_matrix_header<T>(header, 2 * sizeof(size_t));
+}
+
+template<typename S, typename T>
+void read_converted(std::istream& in, size_t n, bool swap_bytes, T* dst) {
+    S buffer[1024];
+    for (size_t done = 0; done < n;) {
+        const size_t count = std::min<size_t>(1024, n - done);
+        in.read(reinterpret_cast<char*>(buffer), sizeof(S) * count);
+        for (size_t i = 0; i < count; ++i) {
+            if (swap_bytes) {
+                char* b = reinterpret_cast<char*>(buffer + i);
+                std::reverse(b, b + sizeof(S));
+            }
+            dst[done + i] = static_cast<T>(buffer[i]);
+        }
+        done += count;
+    }
+}
+
+// Reads the elements of rec into dst, converting the element type and the
+// byte order when they differ from T and the host.
+template<typename T>
+void read_matrix_data(std::istream& in, const matrix_record& rec, T* dst) {
+    const size_t n = rec.rows * rec.cols;
+    if (rec.dtype == matrix_dtype<T>() && !rec.swap_bytes) {
+        in.read(reinterpret_cast<char*>(dst), sizeof(T) * n);
+    } else if (rec.dtype == 1) {
+        read_converted<float>(in, n, rec.swap_bytes, dst);
+    } else if (rec.dtype == 2) {
+        read_converted<double>(in, n, rec.swap_bytes, dst);
+    } else {
+        read_converted<long double>(in, n, rec.swap_bytes, dst);
+    }
+    if (!in) {
+        report_matrix_file("truncated matrix data");
+    }
+}
@@ -0,0 +1,195 @@
+/* matrix_pool.hpp - Aligned, size-bucketed buffer pool for matrix.hpp */
+/* by ValKmjolnir 2026/10/17 */
+
+#pragma once
+
+#include "profile.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <unordered_map>
+#include <vector>
+
+struct matrix_pool_stats {
+    size_t hits = 0;          // requests served from a cached buffer
+    size_t misses = 0;        // requests that went to the system allocator
+    size_t bytes_in_use = 0;  // bytes currently held by matrices
+    size_t peak_bytes = 0;    // high-water mark of bytes_in_use
+    size_t bytes_cached = 0;  // bytes parked in the pool, ready for reuse
+
+    double hit_rate() const {
+        return hits + misses ? static_cast<double>(hits) / (hits + misses) : 0.0;
+    }
+};
+
+// Every buffer is 64-byte aligned (cache line, and one AVX-512 register).
+// Freed buffers are kept in a per-thread free list keyed by their rounded
+// size, so a loop that creates temporaries of the same shape every iteration
+// reaches a steady state with no calls into the system allocator.
+//
+// MATRIX_POOL=0 disables caching, MATRIX_POOL_LIMIT caps the bytes each
+// thread keeps cached (default 256 MiB).
+class matrix_pool {
+public:
+    static constexpr size_t ALIGNMENT = 64;
+
+private:
+    struct global_state {
+        std::atomic<size_t> hits{0};
+        std::atomic<size_t> misses{0};
+        std::atomic<size_t> bytes_in_use{0};
+        std::atomic<size_t> peak_bytes{0};
+        std::atomic<size_t> bytes_cached{0};
+        std::atomic<bool> enabled{true};
+        size_t thread_limit = size_t(256) << 20;
+
+        global_state() {
+            const char* env = std::getenv("MATRIX_POOL");
+            if (env && std::strcmp(env, "0") == 0) {
+                enabled = false;
+            }
+            const char* limit = std::getenv("MATRIX_POOL_LIMIT");
+            if (limit) {
+                thread_limit = std::strtoull(limit, nullptr, 10);
+            }
+        }
+    };
+
+    struct thread_cache {
+        std::unordered_map<size_t, std::vector<void*>> free_lists;
+        size_t cached = 0;
+
+        ~thread_cache() {
+            release_all();
+            destroyed() = true;
+        }
+
+        void release_all() {
+            for (auto& bucket : free_lists) {
+                for (void* p : bucket.second) {
+                    ::operator delete(p, std::align_val_t(ALIGNMENT));
+                }
+                bucket.second.clear();
+            }
+            get_state().bytes_cached -= cached;
+            cached = 0;
+        }
+    };
+
+    static global_state& get_state() {
+        static global_state s;
+        return s;
+    }
+
+    // Stays readable after the thread_local cache is gone, so matrices
+    // destroyed during static destruction fall back to the system allocator.
+    static bool& destroyed() {
+        static thread_local bool flag = false;
+        return flag;
+    }
+
+    static thread_cache& get_cache() {
+        static thread_local thread_cache cache;
+        return cache;
+    }
+
+    static size_t bucket_size(size_t bytes) {
+        return (bytes + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+    }
+
+    static void track_acquire(size_t bytes) {
+        auto& s = get_state();
+        const size_t now = s.bytes_in_use.fetch_add(bytes) + bytes;
+        size_t peak = s.peak_bytes.load(std::memory_order_relaxed);
+        while (now > peak && !s.peak_bytes.compare_exchange_weak(peak, now)) {}
+    }
+
+public:
+    static void* allocate(size_t bytes) {
+        auto& s = get_state();
+        const size_t size = bucket_size(bytes);
+        track_acquire(size);
+        MATRIX_PROFILE_ALLOCATION(size);
+
+        if (s.enabled.load(std::memory_order_relaxed) && !destroyed()) {
+            auto& cache = get_cache();
+            auto it = cache.free_lists.find(size);
+            if (it != cache.free_lists.end() && !it->second.empty()) {
+                void* p = it->second.back();
+                it->second.pop_back();
+                cache.cached -= size;
+                s.bytes_cached -= size;
+                ++s.hits;
+                return p;
+            }
+        }
+        ++s.misses;
+        return ::operator new(size, std::align_val_t(ALIGNMENT));
+    }
+
+    static void deallocate(void* p, size_t bytes) {
+        if (!p) {
+            return;
+        }
+        auto& s = get_state();
+        const size_t size = bucket_size(bytes);
+        s.bytes_in_use -= size;
+
+        if (s.enabled.load(std::memory_order_relaxed) && !destroyed()) {
+            auto& cache = get_cache();
+            if (cache.cached + size <= s.thread_limit) {
+                cache.free_lists[size].push_back(p);
+                cache.cached += size;
+                s.bytes_cached += size;
+                return;
+            }
+        }
+        ::operator delete(p, std::align_val_t(ALIGNMENT));
+    }
+
+    template<typename T>
+    static T* allocate_array(size_t count) {
+        return static_cast<T*>(allocate(count * sizeof(T)));
+    }
+
+    template<typename T>
+    static void deallocate_array(T* p, size_t count) {
+        deallocate(p, count * sizeof(T));
+    }
+
+    // Return this thread's cached buffers to the system.
+    static void trim() {
+        if (!destroyed()) {
+            get_cache().release_all();
+        }
+    }
+
+    static void set_enabled(bool enabled) {
+        get_state().enabled = enabled;
+        if (!enabled) {
+            trim();
+        }
+    }
+
+    static matrix_pool_stats stats() {
+        auto& s = get_state();
+        matrix_pool_stats result;
+        result.hits = s.hits;
+        result.misses = s.misses;
+        result.bytes_in_use = s.bytes_in_use;
+        result.peak_bytes = s.peak_bytes;
+        result.bytes_cached = s.bytes_cached;
+        return result;
+    }
+
+    // Clears the counters, keeps cached buffers and bytes_in_use.
+    static void reset_stats() {
+        auto& s = get_state();
+        s.hits = 0;
+        s.misses = 0;
+        s.peak_bytes = s.bytes_in_use.load();
+    }
+};
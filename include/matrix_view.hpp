@@ -0,0 +1,221 @@
+/* matrix_view.hpp - Non-owning strided views into matrix storage */
+/* by ValKmjolnir 2026/10/17 */
+
+#pragma once
+
+#include "gemm.hpp"
+#include "matrix_expr.hpp"
+
+#include <sstream>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+// Element (r, c) of a view lives at data()[r * row_stride() + c * col_stride()].
+// Views never own memory: slicing, transposing and blocking only change the
+// pointer and strides. matrix_view<const T> is the read-only flavour.
+//
+// Assigning to a view writes through it, copying a view object does not:
+// `v = expr` stores expr into the viewed elements, `auto w = v` aliases them.
+template<typename T>
+class matrix_view: public matrix_expr<std::remove_const_t<T>, matrix_view<T>> {
+public:
+    using value_type = std::remove_const_t<T>;
+
+private:
+    T* num;
+    size_t row;
+    size_t col;
+    size_t rs;
+    size_t cs;
+
+    static void report_range(const char* calc, size_t index, size_t bound) {
+        std::ostringstream oss;
+        oss << "Error: view out of range! In " << calc << ": index " << index
+            << " but size is " << bound << ".";
+        throw std::runtime_error(oss.str());
+    }
+
+    template<typename E, typename Combine>
+    matrix_view& apply(const matrix_expr<value_type, E>& expr, const char* calc, Combine combine) {
+        static_assert(!std::is_const<T>::value, "cannot write through a const view");
+        const auto& e = expr_leaf(expr);
+        if (row != e.get_row() || col != e.get_col()) {
+            report_expr_mismatch(calc, row, col, e.get_row(), e.get_col());
+        }
+        expr_apply(num, rs, cs, e, combine);
+        return *this;
+    }
+
+public:
+    static constexpr bool transcendental = false;
+
+    matrix_view(T* data, size_t rows, size_t cols, size_t row_stride, size_t col_stride = 1):
+        num(data), row(rows), col(cols), rs(row_stride), cs(col_stride) {}
+
+    matrix_view(matrix<value_type>& m):
+        num(m.data()), row(m.get_row()), col(m.get_col()), rs(m.get_col()), cs(1) {}
+
+    template<typename U = T, typename = std::enable_if_t<std::is_const<U>::value>>
+    matrix_view(const matrix<value_type>& m):
+        num(m.data()), row(m.get_row()), col(m.get_col()), rs(m.get_col()), cs(1) {}
+
+    template<typename U,
+             typename = std::enable_if_t<std::is_const<T>::value && std::is_same<const U, T>::value>>
+    matrix_view(const matrix_view<U>& v):
+        num(v.data()), row(v.get_row()), col(v.get_col()), rs(v.row_stride()), cs(v.col_stride()) {}
+
+    matrix_view(const matrix_view&) = default;
+
+public:
+    size_t get_row() const { return row; }
+    size_t get_col() const { return col; }
+    size_t row_stride() const { return rs; }
+    size_t col_stride() const { return cs; }
+    T* data() const { return num; }
+
+    bool contiguous() const { return cs == 1 && (rs == col || row <= 1); }
+    bool aliases(const expr_target<value_type>& t) const {
+        return expr_leaf_aliases<value_type>(num, row, col, rs, cs, t);
+    }
+
+    T& operator()(size_t r, size_t c) const { return num[r * rs + c * cs]; }
+    template<typename M>
+    value_type element(size_t i, M) const { return num[i]; }
+    template<typename M>
+    value_type element(size_t r, size_t c, M) const { return num[r * rs + c * cs]; }
+
+public:
+    matrix_view row_view(size_t r) const {
+        if (r >= row) {
+            report_range("row_view", r, row);
+        }
+        return matrix_view(num + r * rs, 1, col, rs, cs);
+    }
+
+    matrix_view col_view(size_t c) const {
+        if (c >= col) {
+            report_range("col_view", c, col);
+        }
+        return matrix_view(num + c * cs, row, 1, rs, cs);
+    }
+
+    matrix_view block(size_t r, size_t c, size_t rows, size_t cols) const {
+        if (r + rows > row) {
+            report_range("block", r + rows, row);
+        }
+        if (c + cols > col) {
+            report_range("block", c + cols, col);
+        }
+        return matrix_view(num + r * rs + c * cs, rows, cols, rs, cs);
+    }
+
+    matrix_view transpose() const {
+        return matrix_view(num, col, row, cs, rs);
+    }
+
+public:
+    matrix_view& operator=(const matrix_view& other) {
+        return apply(other, "=", assign_combine<value_type>());
+    }
+
+    template<typename E>
+    matrix_view& operator=(const matrix_expr<value_type, E>& expr) {
+        return apply(expr, "=", assign_combine<value_type>());
+    }
+
+    template<typename E>
+    matrix_view& operator+=(const matrix_expr<value_type, E>& expr) {
+        return apply(expr, "+=", add_op<value_type>());
+    }
+
+    template<typename E>
+    matrix_view& operator-=(const matrix_expr<value_type, E>& expr) {
+        return apply(expr, "-=", sub_op<value_type>());
+    }
+
+    matrix_view& operator*=(const value_type B) {
+        static_assert(!std::is_const<T>::value, "cannot write through a const view");
+        parallel_dispatch::for_each_2d(parallel_op::elementwise, row, col, [&](size_t r, size_t c) {
+            num[r * rs + c * cs] *= B;
+        });
+        return *this;
+    }
+
+    matrix_view& operator/=(const value_type B) {
+        static_assert(!std::is_const<T>::value, "cannot write through a const view");
+        parallel_dispatch::for_each_2d(parallel_op::elementwise, row, col, [&](size_t r, size_t c) {
+            num[r * rs + c * cs] /= B;
+        });
+        return *this;
+    }
+};
+
+template<typename T>
+bool view_overlap(const matrix_view<T>& a, const matrix_view<const T>& b) {
+    if (!a.get_row() || !a.get_col() || !b.get_row() || !b.get_col()) {
+        return false;
+    }
+    const T* a_begin = a.data();
+    const T* a_end = a_begin + (a.get_row() - 1) * a.row_stride() + (a.get_col() - 1) * a.col_stride() + 1;
+    const T* b_begin = b.data();
+    const T* b_end = b_begin + (b.get_row() - 1) * b.row_stride() + (b.get_col() - 1) * b.col_stride() + 1;
+    return a_begin < b_end && b_begin < a_end;
+}
+
+// Validates op(A) * op(B) and returns its shape.
+template<typename T>
+std::pair<size_t, size_t> gemm_shape(const matrix_view<const T>& A, const matrix_view<const T>& B,
+                                     bool transA, bool transB) {
+    const size_t m = transA ? A.get_col() : A.get_row();
+    const size_t k = transA ? A.get_row() : A.get_col();
+    const size_t kb = transB ? B.get_col() : B.get_row();
+    const size_t n = transB ? B.get_row() : B.get_col();
+    if (!m || !k || !kb || !n) {
+        throw std::runtime_error("Error: matrix size is zero! (gemm)");
+    } else if (k != kb) {
+        std::ostringstream oss;
+        oss << "Error: matrix size not match! In calculation gemm: op(A) is ("
+            << m << " x " << k << "), but op(B) is (" << kb << " x " << n << ").";
+        throw std::runtime_error(oss.str());
+    }
+    return {m, n};
+}
+
+// C = alpha * op(A) * op(B) + beta * C on arbitrary strided views.
+// C must already have the right shape. Overlap between C and an operand is
+// detected and computed through a temporary.
+template<typename T>
+void gemm(matrix_view<T> C, matrix_view<const T> A, matrix_view<const T> B,
+          const T alpha = 1, const T beta = 0,
+          const bool transA = false, const bool transB = false) {
+    const auto shape = gemm_shape(A, B, transA, transB);
+    const size_t m = shape.first;
+    const size_t n = shape.second;
+    const size_t k = transA ? A.get_row() : A.get_col();
+    if (C.get_row() != m || C.get_col() != n) {
+        report_expr_mismatch("gemm", m, n, C.get_row(), C.get_col());
+    }
+
+    const size_t rsa = transA ? A.col_stride() : A.row_stride();
+    const size_t csa = transA ? A.row_stride() : A.col_stride();
+    const size_t rsb = transB ? B.col_stride() : B.row_stride();
+    const size_t csb = transB ? B.row_stride() : B.col_stride();
+
+    if (view_overlap(C, A) || view_overlap(C, B) || (C.col_stride() != 1 && C.row_stride() != 1)) {
+        matrix<T> Temp(m, n);
+        if (beta != 0) {
+            Temp.view() = C;
+        }
+        gemm_kernel<T>::run(m, n, k, A.data(), rsa, csa, B.data(), rsb, csb,
+                            Temp.data(), n, alpha, beta, true);
+        C = Temp;
+    } else if (C.col_stride() == 1) {
+        gemm_kernel<T>::run(m, n, k, A.data(), rsa, csa, B.data(), rsb, csb,
+                            C.data(), C.row_stride(), alpha, beta, true);
+    } else {
+        // column-major destination: C^T = op(B)^T * op(A)^T
+        gemm_kernel<T>::run(n, m, k, B.data(), csb, rsb, A.data(), csa, rsa,
+                            C.data(), C.col_stride(), alpha, beta, true);
+    }
+}
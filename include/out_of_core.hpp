@@ -0,0 +1,271 @@
+/* out_of_core.hpp - Tiled GEMM on matrix files larger than memory */
+/* by ValKmjolnir 2026/10/17 */
+
+#pragma once
+
+#include "gemm.hpp"
+#include "matrix_io.hpp"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <future>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// A file read and written at explicit offsets, so the prefetch task and the
+// main thread never share a file position.
+class tile_file {
+private:
+    int fd;
+    std::string path;
+
+public:
+    tile_file(const std::string& p, int flags): fd(-1), path(p) {
+        fd = ::open(path.c_str(), flags, 0644);
+        if (fd < 0) {
+            throw std::runtime_error("Error: cannot open " + path);
+        }
+    }
+
+    ~tile_file() {
+        ::close(fd);
+    }
+
+    tile_file(const tile_file&) = delete;
+    tile_file& operator=(const tile_file&) = delete;
+
+    size_t size() const {
+        return static_cast<size_t>(status().st_size);
+    }
+
+    // true when both descriptors refer to the same file, whatever the paths
+    bool same_file(const tile_file& other) const {
+        const struct stat a = status();
+        const struct stat b = other.status();
+        return a.st_dev == b.st_dev && a.st_ino == b.st_ino;
+    }
+
+    struct stat status() const {
+        struct stat st;
+        if (::fstat(fd, &st) != 0) {
+            throw std::runtime_error("Error: cannot stat " + path);
+        }
+        return st;
+    }
+
+    void read(void* dst, size_t bytes, size_t offset) const {
+        char* p = static_cast<char*>(dst);
+        while (bytes) {
+            const ssize_t got = ::pread(fd, p, bytes, static_cast<off_t>(offset));
+            if (got <= 0) {
+                throw std::runtime_error("Error: cannot read " + path);
+            }
+            p += got;
+            bytes -= static_cast<size_t>(got);
+            offset += static_cast<size_t>(got);
+        }
+    }
+
+    void write(const void* src, size_t bytes, size_t offset) const {
+        const char* p = static_cast<const char*>(src);
+        while (bytes) {
+            const ssize_t put = ::pwrite(fd, p, bytes, static_cast<off_t>(offset));
+            if (put <= 0) {
+                throw std::runtime_error("Error: cannot write " + path);
+            }
+            p += put;
+            bytes -= static_cast<size_t>(put);
+            offset += static_cast<size_t>(put);
+        }
+    }
+
+    void resize(size_t bytes) const {
+        if (::ftruncate(fd, static_cast<off_t>(bytes)) != 0) {
+            throw std::runtime_error("Error: cannot resize " + path);
+        }
+    }
+};
+
+// The first matrix record of a file, elements read a block at a time.
+template<typename T>
+class tile_source {
+private:
+    tile_file file;
+    size_t row;
+    size_t col;
+    size_t data_start;
+
+public:
+    explicit tile_source(const std::string& path): file(path, O_RDONLY), row(0), col(0), data_start(0) {
+        const size_t size = file.size();
+        char header[MATRIX_FILE_HEADER_SIZE];
+        const size_t got = std::min(size, MATRIX_FILE_HEADER_SIZE);
+        file.read(header, got, 0);
+        const matrix_record rec = parse_matrix_header<T>(header, got);
+        if (rec.dtype != matrix_dtype<T>() || rec.swap_bytes) {
+            report_matrix_file("cannot stream " + path + ", element type or byte order differs");
+        }
+        if (rec.data_offset > size || rec.data_bytes() > size - rec.data_offset) {
+            report_matrix_file("truncated matrix data in " + path);
+        }
+        row = rec.rows;
+        col = rec.cols;
+        data_start = rec.data_offset;
+    }
+
+    size_t get_row() const { return row; }
+    size_t get_col() const { return col; }
+    const tile_file& get_file() const { return file; }
+
+    // dst (rows x cols, row-major) = elements [r, r + rows) x [c, c + cols)
+    void read_block(size_t r, size_t c, size_t rows, size_t cols, T* dst) const {
+        if (cols == col) {
+            file.read(dst, sizeof(T) * rows * cols, data_start + sizeof(T) * r * col);
+            return;
+        }
+        for (size_t i = 0; i < rows; ++i)
+            file.read(dst + i * cols, sizeof(T) * cols, data_start + sizeof(T) * ((r + i) * col + c));
+    }
+};
+
+// Tile sizes of C = A * B (m x k times k x n) whose working set, two A and
+// two B tiles for double buffering plus one C tile, fits in a budget.
+struct out_of_core_tiling {
+    size_t tm;
+    size_t tn;
+    size_t tk;
+
+    template<typename T>
+    static out_of_core_tiling choose(size_t m, size_t n, size_t k, size_t budget_bytes) {
+        const size_t elements = budget_bytes / sizeof(T);
+        if (2 * (m * k + k * n) + m * n <= elements) {
+            return {m, n, k};
+        }
+        // Square C tiles, the rest of the budget goes to the depth. Tiles
+        // are rounded to the gemm_kernel blocking so they have no edge
+        // panels of their own.
+        using blk = gemm_blocking<T>;
+        const size_t t = static_cast<size_t>(std::sqrt(static_cast<double>(elements) / 5));
+        out_of_core_tiling tiling;
+        tiling.tm = std::min(m, t > blk::MR ? t / blk::MR * blk::MR : t);
+        tiling.tn = std::min(n, t > blk::NR ? t / blk::NR * blk::NR : t);
+        const size_t c_tile = tiling.tm * tiling.tn;
+        tiling.tk = c_tile < elements ? std::min(k, (elements - c_tile) / (2 * (tiling.tm + tiling.tn))) : 0;
+        if (tiling.tk < k && tiling.tk > blk::KC) {
+            tiling.tk = tiling.tk / blk::KC * blk::KC;
+        }
+        if (!tiling.tm || !tiling.tn || !tiling.tk) {
+            std::ostringstream oss;
+            oss << "Error: tile budget of " << budget_bytes << " bytes is too small! (gemm_out_of_core)";
+            throw std::runtime_error(oss.str());
+        }
+        return tiling;
+    }
+};
+
+// C = alpha * A * B where A, B and C are matrix files (matrix_io.hpp
+// format), none of which has to fit in memory. C is written to c_path,
+// which must not be the file of A or B.
+//
+// C is computed one tm x tn tile at a time, accumulating tk-deep slices of
+// A and B with gemm_kernel. While a slice is multiplied, the next one is
+// read from disk by a background task into the other half of a double
+// buffer, so I/O overlaps with compute. When everything fits in
+// budget_bytes this is a single read and one in-memory gemm.
+//
+// A and B must hold T in the host byte order, convert other files with
+// matrix::load and save first.
+template<typename T>
+void gemm_out_of_core(const std::string& a_path, const std::string& b_path, const std::string& c_path,
+                      size_t budget_bytes = static_cast<size_t>(256) << 20, T alpha = 1) {
+    const tile_source<T> A(a_path);
+    const tile_source<T> B(b_path);
+    const size_t m = A.get_row();
+    const size_t k = A.get_col();
+    const size_t n = B.get_col();
+    if (!m || !k || !B.get_row() || !n) {
+        throw std::runtime_error("Error: matrix size is zero! (gemm_out_of_core)");
+    } else if (k != B.get_row()) {
+        std::ostringstream oss;
+        oss << "Error: matrix size not match! In calculation gemm_out_of_core: A is ("
+            << m << " x " << k << "), but B is (" << B.get_row() << " x " << n << ").";
+        throw std::runtime_error(oss.str());
+    }
+    const out_of_core_tiling tiling = out_of_core_tiling::choose<T>(m, n, k, budget_bytes);
+
+    std::ostringstream header;
+    write_matrix_header<T>(header, m, n);
+    const std::string head = header.str();
+    // opened without O_TRUNC: an output that is also an input must be
+    // rejected before any of its data is lost
+    const tile_file C(c_path, O_RDWR | O_CREAT);
+    if (C.same_file(A.get_file()) || C.same_file(B.get_file())) {
+        throw std::runtime_error("Error: output " + c_path + " is also an input! (gemm_out_of_core)");
+    }
+    C.resize(0);
+    C.write(head.data(), head.size(), 0);
+    C.resize(head.size() + sizeof(T) * m * n);
+
+    // every (C tile, depth slice) in order, depth innermost
+    struct step {
+        size_t i, j, p;
+    };
+    std::vector<step> steps;
+    for (size_t i = 0; i < m; i += tiling.tm)
+        for (size_t j = 0; j < n; j += tiling.tn)
+            for (size_t p = 0; p < k; p += tiling.tk)
+                steps.push_back({i, j, p});
+
+    // uninitialized, every tile is fully read or written before use
+    aligned_buffer<T> a_buffer[2], b_buffer[2], c_buffer;
+    T* a_tile[2];
+    T* b_tile[2];
+    for (size_t b = 0; b < 2; ++b) {
+        a_tile[b] = a_buffer[b].reserve(tiling.tm * tiling.tk);
+        b_tile[b] = b_buffer[b].reserve(tiling.tk * tiling.tn);
+    }
+    T* c_tile = c_buffer.reserve(tiling.tm * tiling.tn);
+
+    auto load = [&](size_t s, size_t b) {
+        const step& st = steps[s];
+        const size_t rows = std::min(tiling.tm, m - st.i);
+        const size_t cols = std::min(tiling.tn, n - st.j);
+        const size_t depth = std::min(tiling.tk, k - st.p);
+        A.read_block(st.i, st.p, rows, depth, a_tile[b]);
+        B.read_block(st.p, st.j, depth, cols, b_tile[b]);
+    };
+
+    load(0, 0);
+    for (size_t s = 0; s < steps.size(); ++s) {
+        const size_t b = s % 2;
+        std::future<void> next;
+        if (s + 1 < steps.size()) {
+            next = std::async(std::launch::async, load, s + 1, 1 - b);
+        }
+
+        const step& st = steps[s];
+        const size_t rows = std::min(tiling.tm, m - st.i);
+        const size_t cols = std::min(tiling.tn, n - st.j);
+        const size_t depth = std::min(tiling.tk, k - st.p);
+        gemm_kernel<T>::run(rows, cols, depth, a_tile[b], depth, 1, b_tile[b], cols, 1,
+                            c_tile, cols, alpha, st.p == 0 ? T(0) : T(1), true);
+
+        if (st.p + depth == k && cols == n) {
+            C.write(c_tile, sizeof(T) * rows * cols, head.size() + sizeof(T) * st.i * n);
+        } else if (st.p + depth == k) {
+            for (size_t r = 0; r < rows; ++r)
+                C.write(c_tile + r * cols, sizeof(T) * cols,
+                        head.size() + sizeof(T) * ((st.i + r) * n + st.j));
+        }
+        if (next.valid()) {
+            next.get();
+        }
+    }
+}
@@ -0,0 +1,188 @@
+/* parallel.hpp - Size-adaptive serial/OpenMP dispatch for matrix.hpp */
+/* by ValKmjolnir 2026/10/17 */
+
+#pragma once
+
+#include "profile.hpp"
+
+#include <omp.h>
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+// Kinds of loops with different cost per element. Each kind has its own
+// cutoff: below it the loop runs serially (still vectorized), at or above it
+// the loop is split across OpenMP threads.
+enum class parallel_op {
+    copy,           // memcpy-like loops
+    elementwise,    // + - * / and other cheap arithmetic
+    transcendental, // exp, tanh, pow ...
+    reduction,      // sums, norms and axis reductions
+    count
+};
+
+// Cutoffs come from, in order of precedence:
+//   1. parallel_dispatch::set_threshold()
+//   2. MATRIX_PARALLEL_THRESHOLD_<KIND> (COPY, ELEMENTWISE, TRANSCENDENTAL, REDUCTION)
+//   3. MATRIX_PARALLEL_THRESHOLD, applied to every kind
+//   4. parallel_dispatch::calibrate(), run at startup if MATRIX_PARALLEL_CALIBRATE=1
+//   5. built-in defaults
+class parallel_dispatch {
+private:
+    static constexpr size_t KINDS = static_cast<size_t>(parallel_op::count);
+
+    struct state {
+        std::atomic<size_t> threshold[KINDS];
+
+        state() {
+            threshold[static_cast<size_t>(parallel_op::copy)] = 1 << 16;
+            threshold[static_cast<size_t>(parallel_op::elementwise)] = 1 << 15;
+            threshold[static_cast<size_t>(parallel_op::transcendental)] = 1 << 12;
+            threshold[static_cast<size_t>(parallel_op::reduction)] = 1 << 15;
+
+            const char* env_all = std::getenv("MATRIX_PARALLEL_THRESHOLD");
+            const char* calibrate_env = std::getenv("MATRIX_PARALLEL_CALIBRATE");
+            if (calibrate_env && std::strcmp(calibrate_env, "1") == 0) {
+                for (size_t k = 0; k < KINDS; ++k) {
+                    threshold[k] = measure(static_cast<parallel_op>(k));
+                }
+            }
+            for (size_t k = 0; k < KINDS; ++k) {
+                const char* env = std::getenv(env_name(static_cast<parallel_op>(k)));
+                if (env) {
+                    threshold[k] = std::strtoull(env, nullptr, 10);
+                } else if (env_all) {
+                    threshold[k] = std::strtoull(env_all, nullptr, 10);
+                }
+            }
+        }
+    };
+
+    static state& get_state() {
+        static state s;
+        return s;
+    }
+
+    static const char* env_name(parallel_op op) {
+        switch (op) {
+            case parallel_op::copy: return "MATRIX_PARALLEL_THRESHOLD_COPY";
+            case parallel_op::elementwise: return "MATRIX_PARALLEL_THRESHOLD_ELEMENTWISE";
+            case parallel_op::transcendental: return "MATRIX_PARALLEL_THRESHOLD_TRANSCENDENTAL";
+            case parallel_op::reduction: return "MATRIX_PARALLEL_THRESHOLD_REDUCTION";
+            default: return "";
+        }
+    }
+
+    template<typename F>
+    static double time_loop(size_t size, bool parallel, F&& body) {
+        using clk = std::chrono::steady_clock;
+        double best = 1e30;
+        for (int rep = 0; rep < 5; ++rep) {
+            auto begin = clk::now();
+            if (parallel) {
+                #pragma omp parallel for simd
+                for (size_t i = 0; i < size; ++i)
+                    body(i);
+            } else {
+                #pragma omp simd
+                for (size_t i = 0; i < size; ++i)
+                    body(i);
+            }
+            const double t = std::chrono::duration<double>(clk::now() - begin).count();
+            best = t < best ? t : best;
+        }
+        return best;
+    }
+
+    // Smallest power of two where the parallel loop beats the serial one.
+    static size_t measure(parallel_op op) {
+        if (omp_get_max_threads() <= 1) {
+            return static_cast<size_t>(-1);
+        }
+        const size_t max_size = 1 << 22;
+        std::vector<float> src(max_size, 0.5f), dst(max_size);
+        float* d = dst.data();
+        const float* s = src.data();
+        for (size_t size = 1 << 8; size <= max_size; size <<= 1) {
+            double serial = 0, parallel = 0;
+            switch (op) {
+                case parallel_op::copy:
+                    serial = time_loop(size, false, [=](size_t i) { d[i] = s[i]; });
+                    parallel = time_loop(size, true, [=](size_t i) { d[i] = s[i]; });
+                    break;
+                case parallel_op::transcendental:
+                    serial = time_loop(size, false, [=](size_t i) { d[i] = std::exp(s[i]); });
+                    parallel = time_loop(size, true, [=](size_t i) { d[i] = std::exp(s[i]); });
+                    break;
+                default:
+                    serial = time_loop(size, false, [=](size_t i) { d[i] = d[i] * s[i] + s[i]; });
+                    parallel = time_loop(size, true, [=](size_t i) { d[i] = d[i] * s[i] + s[i]; });
+                    break;
+            }
+            if (parallel < serial) {
+                return size;
+            }
+        }
+        return max_size;
+    }
+
+public:
+    static size_t threshold(parallel_op op) {
+        return get_state().threshold[static_cast<size_t>(op)].load(std::memory_order_relaxed);
+    }
+
+    static void set_threshold(parallel_op op, size_t size) {
+        get_state().threshold[static_cast<size_t>(op)].store(size, std::memory_order_relaxed);
+    }
+
+    // Re-measure every cutoff on this machine with the current thread count.
+    static void calibrate() {
+        for (size_t k = 0; k < KINDS; ++k) {
+            set_threshold(static_cast<parallel_op>(k), measure(static_cast<parallel_op>(k)));
+        }
+    }
+
+    static bool use_parallel(parallel_op op, size_t size) {
+        const bool parallel = size >= threshold(op) && omp_get_max_threads() > 1 && !omp_in_parallel();
+        if (parallel) {
+            MATRIX_PROFILE_PARALLEL_REGION();
+        }
+        return parallel;
+    }
+
+    // body(i) for every i in [0, size)
+    template<typename F>
+    static void for_each(parallel_op op, size_t size, F&& body) {
+        if (use_parallel(op, size)) {
+            #pragma omp parallel for simd
+            for (size_t i = 0; i < size; ++i)
+                body(i);
+        } else {
+            #pragma omp simd
+            for (size_t i = 0; i < size; ++i)
+                body(i);
+        }
+    }
+
+    // body(r, c) for every element of a rows x cols range, rows split across threads
+    template<typename F>
+    static void for_each_2d(parallel_op op, size_t rows, size_t cols, F&& body) {
+        if (use_parallel(op, rows * cols)) {
+            #pragma omp parallel for
+            for (size_t r = 0; r < rows; ++r)
+                #pragma omp simd
+                for (size_t c = 0; c < cols; ++c)
+                    body(r, c);
+        } else {
+            for (size_t r = 0; r < rows; ++r)
+                #pragma omp simd
+                for (size_t c = 0; c < cols; ++c)
+                    body(r, c);
+        }
+    }
+};
@@ -0,0 +1,293 @@
+/* profile.hpp - Opt-in per-operation counters and trace export */
+/* by ValKmjolnir 2026/10/17 */
+
+#pragma once
+
+// Build with -DMATRIX_ENABLE_PROFILING to record, per operation: calls,
+// total and self wall time, FLOPs, bytes moved, pool allocations and
+// OpenMP parallel regions. Without it every MATRIX_PROFILE_* macro expands
+// to a no-op and its arguments are never evaluated.
+//
+//   matrix_profiler::instance().report(std::cout);      summary table
+//   matrix_profiler::instance().write_trace("t.json");  chrome://tracing, Perfetto
+//
+// MATRIX_PROFILE_TRACE=<path> records a trace and writes it at exit,
+// MATRIX_PROFILE_SUMMARY=1 prints the table to stderr at exit.
+
+#ifdef MATRIX_ENABLE_PROFILING
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+struct profile_stats {
+    size_t calls = 0;
+    double total_ns = 0;        // including nested operations
+    double self_ns = 0;         // excluding nested operations
+    double flops = 0;
+    double bytes = 0;
+    size_t allocations = 0;     // matrix_pool requests made directly by this op
+    size_t allocated_bytes = 0;
+    size_t parallel_regions = 0;
+};
+
+class matrix_profiler {
+private:
+    struct event {
+        const char* name;
+        int64_t begin_ns;
+        int64_t duration_ns;
+        uint32_t tid;
+        double flops;
+        double bytes;
+        size_t allocations;
+    };
+
+    struct frame {
+        const char* name;
+        int64_t begin_ns;
+        int64_t child_ns;
+        size_t allocations;
+        size_t allocated_bytes;
+        size_t parallel_regions;
+    };
+
+    struct name_less {
+        bool operator()(const char* a, const char* b) const { return std::strcmp(a, b) < 0; }
+    };
+
+    mutable std::mutex lock;
+    std::map<const char*, profile_stats, name_less> ops;
+    std::vector<event> events;
+    size_t max_events = 1 << 20;
+    size_t dropped_events = 0;
+    std::atomic<bool> tracing{false};
+    std::atomic<uint32_t> next_tid{0};
+    std::string exit_trace;
+    bool exit_summary = false;
+    const std::chrono::steady_clock::time_point origin = std::chrono::steady_clock::now();
+
+    matrix_profiler() {
+        const char* trace = std::getenv("MATRIX_PROFILE_TRACE");
+        if (trace && *trace) {
+            exit_trace = trace;
+            tracing = true;
+        }
+        const char* summary = std::getenv("MATRIX_PROFILE_SUMMARY");
+        exit_summary = summary && std::strcmp(summary, "0") != 0;
+        const char* limit = std::getenv("MATRIX_PROFILE_MAX_EVENTS");
+        if (limit) {
+            max_events = std::strtoull(limit, nullptr, 10);
+        }
+    }
+
+    ~matrix_profiler() {
+        if (exit_summary) {
+            report(std::cerr);
+        }
+        if (!exit_trace.empty()) {
+            try {
+                write_trace(exit_trace);
+            } catch (const std::exception& e) {
+                std::cerr << e.what() << std::endl;
+            }
+        }
+    }
+
+    static std::vector<frame>& stack() {
+        static thread_local std::vector<frame> frames;
+        return frames;
+    }
+
+    uint32_t thread_id() {
+        static thread_local uint32_t id = next_tid++;
+        return id;
+    }
+
+    int64_t now() const {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - origin).count();
+    }
+
+public:
+    matrix_profiler(const matrix_profiler&) = delete;
+    matrix_profiler& operator=(const matrix_profiler&) = delete;
+
+    static matrix_profiler& instance() {
+        static matrix_profiler profiler;
+        return profiler;
+    }
+
+    void begin(const char* name) {
+        stack().push_back({name, now(), 0, 0, 0, 0});
+    }
+
+    void end(double flops, double bytes) {
+        const int64_t finish = now();
+        std::vector<frame>& frames = stack();
+        const frame f = frames.back();
+        frames.pop_back();
+        const int64_t duration = finish - f.begin_ns;
+        if (!frames.empty()) {
+            frames.back().child_ns += duration;
+        }
+
+        std::lock_guard<std::mutex> guard(lock);
+        profile_stats& s = ops[f.name];
+        ++s.calls;
+        s.total_ns += duration;
+        s.self_ns += duration - f.child_ns;
+        s.flops += flops;
+        s.bytes += bytes;
+        s.allocations += f.allocations;
+        s.allocated_bytes += f.allocated_bytes;
+        s.parallel_regions += f.parallel_regions;
+        if (tracing.load(std::memory_order_relaxed)) {
+            if (events.size() < max_events) {
+                events.push_back({f.name, f.begin_ns, duration, thread_id(), flops, bytes, f.allocations});
+            } else {
+                ++dropped_events;
+            }
+        }
+    }
+
+    // Charged to the innermost operation of the calling thread, if any.
+    static void count_allocation(size_t bytes) {
+        std::vector<frame>& frames = stack();
+        if (!frames.empty()) {
+            ++frames.back().allocations;
+            frames.back().allocated_bytes += bytes;
+        }
+    }
+
+    static void count_parallel_region() {
+        std::vector<frame>& frames = stack();
+        if (!frames.empty()) {
+            ++frames.back().parallel_regions;
+        }
+    }
+
+    void set_tracing(bool enabled) {
+        tracing = enabled;
+    }
+
+    void reset() {
+        std::lock_guard<std::mutex> guard(lock);
+        ops.clear();
+        events.clear();
+        dropped_events = 0;
+    }
+
+    std::map<std::string, profile_stats> snapshot() const {
+        std::lock_guard<std::mutex> guard(lock);
+        return std::map<std::string, profile_stats>(ops.begin(), ops.end());
+    }
+
+    profile_stats get(const std::string& name) const {
+        std::lock_guard<std::mutex> guard(lock);
+        const auto it = ops.find(name.c_str());
+        return it == ops.end() ? profile_stats() : it->second;
+    }
+
+    // One line per operation, most self time first.
+    void report(std::ostream& out) const {
+        const auto all = snapshot();
+        std::vector<std::pair<std::string, profile_stats>> rows(all.begin(), all.end());
+        std::sort(rows.begin(), rows.end(), [](const auto& a, const auto& b) {
+            return a.second.self_ns > b.second.self_ns;
+        });
+        double self_total = 0;
+        for (const auto& row : rows)
+            self_total += row.second.self_ns;
+
+        const std::ios::fmtflags flags = out.flags();
+        const std::streamsize precision = out.precision();
+        out << std::left << std::setw(22) << "operation" << std::right
+            << std::setw(10) << "calls" << std::setw(12) << "total ms" << std::setw(12) << "self ms"
+            << std::setw(8) << "self%" << std::setw(10) << "GFLOP/s" << std::setw(10) << "GB/s"
+            << std::setw(10) << "allocs" << std::setw(11) << "alloc MB" << std::setw(9) << "omp" << "\n";
+        out << std::fixed;
+        for (const auto& row : rows) {
+            const profile_stats& s = row.second;
+            out << std::left << std::setw(22) << row.first << std::right
+                << std::setw(10) << s.calls
+                << std::setprecision(3) << std::setw(12) << s.total_ns * 1e-6 << std::setw(12) << s.self_ns * 1e-6
+                << std::setprecision(1) << std::setw(8) << (self_total > 0 ? 100 * s.self_ns / self_total : 0)
+                << std::setprecision(2) << std::setw(10) << (s.total_ns > 0 ? s.flops / s.total_ns : 0)
+                << std::setw(10) << (s.total_ns > 0 ? s.bytes / s.total_ns : 0)
+                << std::setw(10) << s.allocations
+                << std::setw(11) << s.allocated_bytes / 1048576.0
+                << std::setw(9) << s.parallel_regions << "\n";
+        }
+        out.flags(flags);
+        out.precision(precision);
+    }
+
+    // Chrome trace event format, one complete ("X") event per operation call.
+    void write_trace(const std::string& path) const {
+        std::ofstream out(path);
+        if (!out.is_open()) {
+            throw std::runtime_error("Error: cannot open " + path);
+        }
+        std::lock_guard<std::mutex> guard(lock);
+        out << std::setprecision(15) << "{\"displayTimeUnit\": \"ms\", \"otherData\": {\"dropped_events\": "
+            << dropped_events << "}, \"traceEvents\": [\n";
+        for (size_t i = 0; i < events.size(); ++i) {
+            const event& e = events[i];
+            out << "{\"name\": \"" << e.name << "\", \"cat\": \"matrix\", \"ph\": \"X\", \"pid\": 1, \"tid\": " << e.tid
+                << ", \"ts\": " << e.begin_ns * 1e-3 << ", \"dur\": " << e.duration_ns * 1e-3
+                << ", \"args\": {\"flops\": " << e.flops << ", \"bytes\": " << e.bytes
+                << ", \"allocations\": " << e.allocations << "}}" << (i + 1 < events.size() ? ",\n" : "\n");
+        }
+        out << "]}\n";
+    }
+};
+
+// Times the enclosing block as one call of `name`. flops and bytes are
+// evaluated up front, name must outlive the profiler (a string literal).
+class profile_scope {
+private:
+    double flops;
+    double bytes;
+
+public:
+    profile_scope(const char* name, double f, double b): flops(f), bytes(b) {
+        matrix_profiler::instance().begin(name);
+    }
+
+    ~profile_scope() {
+        matrix_profiler::instance().end(flops, bytes);
+    }
+
+    profile_scope(const profile_scope&) = delete;
+    profile_scope& operator=(const profile_scope&) = delete;
+};
+
+#define MATRIX_PROFILE_CONCAT_INNER(a, b) a##b
+#define MATRIX_PROFILE_CONCAT(a, b) MATRIX_PROFILE_CONCAT_INNER(a, b)
+#define MATRIX_PROFILE_SCOPE(name, flops, bytes) \
+    profile_scope MATRIX_PROFILE_CONCAT(matrix_profile_scope_, __LINE__)( \
+        name, static_cast<double>(flops), static_cast<double>(bytes))
+#define MATRIX_PROFILE_ALLOCATION(bytes) matrix_profiler::count_allocation(bytes)
+#define MATRIX_PROFILE_PARALLEL_REGION() matrix_profiler::count_parallel_region()
+
+#else
+
+// sizeof keeps the arguments unevaluated but counts their variables as used
+#define MATRIX_PROFILE_SCOPE(name, flops, bytes) ((void)sizeof((flops) + (bytes)))
+#define MATRIX_PROFILE_ALLOCATION(bytes) ((void)sizeof(bytes))
+#define MATRIX_PROFILE_PARALLEL_REGION() ((void)0)
+
+#endif
@@ -0,0 +1,217 @@
+/* random.hpp - Counter-based parallel random fill for matrix.hpp */
+/* by ValKmjolnir 2026/10/17 */
+
+#pragma once
+
+#include "parallel.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <random>
+
+// Philox4x32-10 (Salmon et al., "Parallel Random Numbers: As Easy as 1, 2, 3").
+// A block of four 32-bit words is a pure function of (counter, key), so any
+// element can be generated without touching the ones before it. Filling a
+// buffer then splits into independent blocks: threads and SIMD lanes can take
+// any share of them and the result is bit-identical for a given seed.
+struct philox4x32 {
+    static constexpr uint32_t M0 = 0xD2511F53;
+    static constexpr uint32_t M1 = 0xCD9E8D57;
+    static constexpr uint32_t W0 = 0x9E3779B9;
+    static constexpr uint32_t W1 = 0xBB67AE85;
+
+    // {c0, c1, c2, c3} = philox(counter {c0, c1, c2, c3}, key {k0, k1})
+    static void rounds(uint32_t& c0, uint32_t& c1, uint32_t& c2, uint32_t& c3, uint32_t k0, uint32_t k1) {
+        for (int round = 0; round < 10; ++round) {
+            const uint64_t p0 = static_cast<uint64_t>(M0) * c0;
+            const uint64_t p1 = static_cast<uint64_t>(M1) * c2;
+            const uint32_t n0 = static_cast<uint32_t>(p1 >> 32) ^ c1 ^ k0;
+            const uint32_t n2 = static_cast<uint32_t>(p0 >> 32) ^ c3 ^ k1;
+            c0 = n0;
+            c1 = static_cast<uint32_t>(p1);
+            c2 = n2;
+            c3 = static_cast<uint32_t>(p0);
+            k0 += W0;
+            k1 += W1;
+        }
+    }
+
+    static void block(uint32_t c0, uint32_t c1, uint32_t c2, uint32_t c3,
+                      uint32_t k0, uint32_t k1, uint32_t out[4]) {
+        rounds(c0, c1, c2, c3, k0, k1);
+        out[0] = c0;
+        out[1] = c1;
+        out[2] = c2;
+        out[3] = c3;
+    }
+
+    // block n of the stream selected by seed
+    static void block(uint64_t seed, uint64_t n, uint32_t out[4]) {
+        block(static_cast<uint32_t>(n), static_cast<uint32_t>(n >> 32), 0, 0,
+              static_cast<uint32_t>(seed), static_cast<uint32_t>(seed >> 32), out);
+    }
+};
+
+// Seeds for calls that do not pass one. Each call returns a new seed derived
+// from a base seed, which is MATRIX_RANDOM_SEED if set (so a whole run can be
+// replayed) and std::random_device otherwise. random_config::set_seed()
+// restarts the sequence from a given base.
+class random_config {
+private:
+    struct state {
+        std::atomic<uint64_t> base;
+        std::atomic<uint64_t> count;
+
+        state(): count(0) {
+            const char* env = std::getenv("MATRIX_RANDOM_SEED");
+            if (env) {
+                base = std::strtoull(env, nullptr, 10);
+            } else {
+                std::random_device rd;
+                base = (static_cast<uint64_t>(rd()) << 32) | rd();
+            }
+        }
+    };
+
+    static state& get_state() {
+        static state s;
+        return s;
+    }
+
+    // splitmix64 finalizer, consecutive counts give unrelated seeds
+    static uint64_t mix(uint64_t x) {
+        x += 0x9E3779B97F4A7C15ull;
+        x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+        x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+        return x ^ (x >> 31);
+    }
+
+public:
+    static void set_seed(uint64_t seed) {
+        get_state().base.store(seed, std::memory_order_relaxed);
+        get_state().count.store(0, std::memory_order_relaxed);
+    }
+
+    static uint64_t next_seed() {
+        state& s = get_state();
+        const uint64_t n = s.count.fetch_add(1, std::memory_order_relaxed);
+        return mix(s.base.load(std::memory_order_relaxed) + mix(n));
+    }
+};
+
+// Conversions from random words to T. Every block of 4 words gives
+// PER_BLOCK values: one word per float, two per double (53 random bits).
+// w[j][l] is word j of block l within a chunk.
+template<typename T>
+struct random_bits;
+
+template<>
+struct random_bits<float> {
+    static constexpr size_t PER_BLOCK = 4;
+
+    // [0, 1) on a 2^-24 grid
+    template<size_t N>
+    static float uniform(const uint32_t (&w)[4][N], size_t j, size_t l) {
+        return static_cast<float>(w[j][l] >> 8) * 5.9604644775390625e-8f;
+    }
+};
+
+template<>
+struct random_bits<double> {
+    static constexpr size_t PER_BLOCK = 2;
+
+    // [0, 1) on a 2^-53 grid
+    template<size_t N>
+    static double uniform(const uint32_t (&w)[4][N], size_t j, size_t l) {
+        const uint64_t hi = w[2 * j][l] >> 5;
+        const uint64_t lo = w[2 * j + 1][l] >> 6;
+        return static_cast<double>((hi << 26) | lo) * 1.1102230246251565404e-16;
+    }
+};
+
+template<typename T>
+struct random_bits: random_bits<double> {};
+
+// Fills dst[0, n) from the stream of `seed`. The buffer is cut into chunks
+// of CHUNK blocks, element j * CHUNK + l of a chunk comes from value j of
+// block l, so element i only depends on (seed, i). Blocks are generated with
+// one SIMD lane each, values are converted with contiguous vector stores,
+// and chunks are split across threads.
+template<typename T>
+struct random_kernel {
+    static constexpr size_t PER_BLOCK = random_bits<T>::PER_BLOCK;
+    static constexpr size_t CHUNK = 64;
+    static constexpr size_t CHUNK_SIZE = CHUNK * PER_BLOCK;
+    static_assert(PER_BLOCK % 2 == 0, "normal() takes values in pairs");
+
+private:
+    // gen(words, out) turns a chunk of blocks into CHUNK_SIZE values
+    template<typename Gen>
+    static void fill_chunk(size_t first, T* out, uint64_t seed, Gen& gen) {
+        uint32_t w[4][CHUNK];
+        const uint32_t k0 = static_cast<uint32_t>(seed);
+        const uint32_t k1 = static_cast<uint32_t>(seed >> 32);
+        #pragma omp simd
+        for (size_t l = 0; l < CHUNK; ++l) {
+            const uint64_t b = first + l;
+            uint32_t c0 = static_cast<uint32_t>(b), c1 = static_cast<uint32_t>(b >> 32), c2 = 0, c3 = 0;
+            philox4x32::rounds(c0, c1, c2, c3, k0, k1);
+            w[0][l] = c0;
+            w[1][l] = c1;
+            w[2][l] = c2;
+            w[3][l] = c3;
+        }
+        gen(w, out);
+    }
+
+    template<typename Gen>
+    static void fill(size_t n, T* dst, uint64_t seed, parallel_op op, Gen gen) {
+        const size_t chunks = n / CHUNK_SIZE;
+        #pragma omp parallel for schedule(static) if(parallel_dispatch::use_parallel(op, n))
+        for (size_t c = 0; c < chunks; ++c)
+            fill_chunk(c * CHUNK, dst + c * CHUNK_SIZE, seed, gen);
+
+        // ragged end through a full chunk, so it matches a longer fill
+        const size_t done = chunks * CHUNK_SIZE;
+        if (done < n) {
+            T tail[CHUNK_SIZE];
+            fill_chunk(chunks * CHUNK, tail, seed, gen);
+            std::copy(tail, tail + (n - done), dst + done);
+        }
+    }
+
+public:
+    // uniform in [lo, hi)
+    static void uniform(size_t n, T* dst, T lo, T hi, uint64_t seed) {
+        const T scale = hi - lo;
+        fill(n, dst, seed, parallel_op::elementwise, [=](const uint32_t (&w)[4][CHUNK], T* out) {
+            for (size_t j = 0; j < PER_BLOCK; ++j) {
+                #pragma omp simd
+                for (size_t l = 0; l < CHUNK; ++l)
+                    out[j * CHUNK + l] = lo + scale * random_bits<T>::uniform(w, j, l);
+            }
+        });
+    }
+
+    // normal(mean, stddev), Box-Muller on pairs of uniforms
+    static void normal(size_t n, T* dst, T mean, T stddev, uint64_t seed) {
+        const T two_pi = static_cast<T>(6.283185307179586476925);
+        fill(n, dst, seed, parallel_op::transcendental, [=](const uint32_t (&w)[4][CHUNK], T* out) {
+            for (size_t j = 0; j < PER_BLOCK; j += 2) {
+                #pragma omp simd
+                for (size_t l = 0; l < CHUNK; ++l) {
+                    // 1 - u is in (0, 1], log never sees 0
+                    const T u1 = 1 - random_bits<T>::uniform(w, j, l);
+                    const T u2 = random_bits<T>::uniform(w, j + 1, l);
+                    const T r = stddev * std::sqrt(-2 * std::log(u1));
+                    out[j * CHUNK + l] = mean + r * std::cos(two_pi * u2);
+                    out[(j + 1) * CHUNK + l] = mean + r * std::sin(two_pi * u2);
+                }
+            }
+        });
+    }
+};
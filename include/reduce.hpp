@@ -0,0 +1,157 @@
+/* reduce.hpp - Deterministic pairwise sums and norms for matrix.hpp */
+/* by ValKmjolnir 2026/10/17 */
+
+#pragma once
+
+#include "parallel.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+// Sums with a summation order fixed by the size of the input alone.
+//
+// The input is cut into leaves of BLOCK elements. A leaf is accumulated in
+// LANES vectorized partial sums that are then added pairwise, and the leaf
+// results are added pairwise along a fixed binary tree. Threads only decide
+// who computes which leaf, so the result is bit-identical for any thread
+// count or schedule, and the error grows with log(n) instead of n.
+template<typename T>
+struct reduce_kernel {
+    static constexpr size_t LANES = 16;
+    static constexpr size_t BLOCK = 1024;
+
+private:
+    static T lanes_total(T* acc) {
+        for (size_t width = LANES / 2; width; width /= 2)
+            for (size_t l = 0; l < width; ++l)
+                acc[l] += acc[l + width];
+        return acc[0];
+    }
+
+    // acc[l] += f(begin + j) for j in [0, n), j % LANES == l
+    template<typename F>
+    static void accumulate(T* acc, size_t begin, size_t n, F& f) {
+        size_t j = 0;
+        for (; j + LANES <= n; j += LANES) {
+            #pragma omp simd
+            for (size_t l = 0; l < LANES; ++l)
+                acc[l] += f(begin + j + l);
+        }
+        for (size_t l = 0; j < n; ++j, ++l)
+            acc[l] += f(begin + j);
+    }
+
+    // partial[0] += ... pairwise, the tree depends only on count
+    static T tree(T* partial, size_t count) {
+        for (size_t step = 1; step < count; step *= 2)
+            for (size_t i = 0; i + step < count; i += 2 * step)
+                partial[i] += partial[i + step];
+        return count ? partial[0] : 0;
+    }
+
+    // leaf(k) for every k in [0, leaves), split across threads, then the tree
+    template<typename Leaf>
+    static T combine(size_t leaves, size_t size, Leaf&& leaf) {
+        T local[64];
+        std::vector<T> heap;
+        T* partial = local;
+        if (leaves > 64) {
+            heap.resize(leaves);
+            partial = heap.data();
+        }
+        #pragma omp parallel for schedule(static) if(parallel_dispatch::use_parallel(parallel_op::reduction, size))
+        for (size_t k = 0; k < leaves; ++k)
+            partial[k] = leaf(k);
+        return tree(partial, leaves);
+    }
+
+public:
+    // sum of f(i) for i in [0, n)
+    template<typename F>
+    static T sum(size_t n, F&& f) {
+        const size_t leaves = (n + BLOCK - 1) / BLOCK;
+        return combine(leaves, n, [&](size_t k) {
+            T acc[LANES] = {};
+            accumulate(acc, k * BLOCK, std::min(BLOCK, n - k * BLOCK), f);
+            return lanes_total(acc);
+        });
+    }
+
+    // sum of f(r, c) over a rows x cols range. Wide rows are split into
+    // BLOCK-sized leaves, narrow rows are grouped BLOCK / cols to a leaf.
+    template<typename F>
+    static T sum_2d(size_t rows, size_t cols, F&& f) {
+        if (!rows || !cols) {
+            return 0;
+        }
+        if (cols >= BLOCK) {
+            const size_t per_row = (cols + BLOCK - 1) / BLOCK;
+            return combine(rows * per_row, rows * cols, [&](size_t k) {
+                const size_t r = k / per_row;
+                const size_t c0 = k % per_row * BLOCK;
+                auto at = [&](size_t c) { return f(r, c); };
+                T acc[LANES] = {};
+                accumulate(acc, c0, std::min(BLOCK, cols - c0), at);
+                return lanes_total(acc);
+            });
+        }
+        const size_t group = BLOCK / cols;
+        return combine((rows + group - 1) / group, rows * cols, [&](size_t k) {
+            T acc[LANES] = {};
+            for (size_t r = k * group; r < std::min(rows, (k + 1) * group); ++r) {
+                auto at = [&](size_t c) { return f(r, c); };
+                accumulate(acc, 0, cols, at);
+            }
+            return lanes_total(acc);
+        });
+    }
+
+    // max of |f(i)|, exact in any order
+    template<typename F>
+    static T max_abs(size_t n, F&& f) {
+        const size_t leaves = (n + BLOCK - 1) / BLOCK;
+        T result = 0;
+        #pragma omp parallel for schedule(static) reduction(max:result) if(parallel_dispatch::use_parallel(parallel_op::reduction, n))
+        for (size_t k = 0; k < leaves; ++k) {
+            const size_t begin = k * BLOCK;
+            const size_t len = std::min(BLOCK, n - begin);
+            T acc[LANES] = {};
+            size_t j = 0;
+            for (; j + LANES <= len; j += LANES) {
+                #pragma omp simd
+                for (size_t l = 0; l < LANES; ++l) {
+                    const T a = std::abs(f(begin + j + l));
+                    acc[l] = a > acc[l] ? a : acc[l];
+                }
+            }
+            for (size_t l = 0; j < len; ++j, ++l) {
+                const T a = std::abs(f(begin + j));
+                acc[l] = a > acc[l] ? a : acc[l];
+            }
+            for (size_t l = 0; l < LANES; ++l)
+                result = acc[l] > result ? acc[l] : result;
+        }
+        return result;
+    }
+
+    // sqrt of the sum of f(i)^2 without overflow or underflow. Elements are
+    // scaled by 2^-e, e = ilogb(max |f(i)|), before squaring; a power of two
+    // scales exactly, it is applied in two halves so it never overflows itself.
+    template<typename F>
+    static T norm2(size_t n, F&& f) {
+        const T max_val = max_abs(n, f);
+        if (max_val == 0 || !std::isfinite(max_val)) {
+            return max_val;
+        }
+        const int e = std::ilogb(max_val);
+        const T s1 = std::ldexp(T(1), -e / 2);
+        const T s2 = std::ldexp(T(1), -e - (-e / 2));
+        const T scaled = sum(n, [&](size_t i) {
+            const T x = f(i) * s1 * s2;
+            return x * x;
+        });
+        return std::ldexp(std::sqrt(scaled), e);
+    }
+};
@@ -0,0 +1,110 @@
+/* softmax.hpp - Row-wise online softmax kernels used by matrix.hpp */
+/* by ValKmjolnir 2026/10/17 */
+
+#pragma once
+
+#include "parallel.hpp"
+#include "reduce.hpp"
+#include "simd_math.hpp"
+
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+// Softmax over each row of a row-major rows x cols array.
+//
+// Pass 1 reads the row once and keeps a running max and a running sum of
+// exp(x - max) per SIMD lane, rescaling the sum whenever the max grows.
+// Pass 2 writes exp(x - max) / sum. Rows are split across threads, lanes
+// within a row are vectorized, and there is one parallel region per call.
+template<typename T>
+struct softmax_kernel {
+    static constexpr size_t LANES = 16;
+
+    // max and sum of exp(x[j] - max) over j in [0, n)
+    template<typename M>
+    static void max_sum(const T* x, size_t n, T& max_out, T& sum_out, M m) {
+        T mx[LANES];
+        T sm[LANES];
+        for (size_t l = 0; l < LANES; ++l) {
+            mx[l] = std::numeric_limits<T>::lowest();
+            sm[l] = 0;
+        }
+
+        // one exp per element: exp(-|x - max|) either rescales the old sum
+        // (new max) or is the new term (old max)
+        size_t j = 0;
+        for (; j + LANES <= n; j += LANES) {
+            #pragma omp simd
+            for (size_t l = 0; l < LANES; ++l) {
+                const T v = x[j + l];
+                const T e = math_exp(v > mx[l] ? mx[l] - v : v - mx[l], m);
+                sm[l] = v > mx[l] ? sm[l] * e + 1 : sm[l] + e;
+                mx[l] = v > mx[l] ? v : mx[l];
+            }
+        }
+        for (size_t l = 0; j < n; ++j, ++l) {
+            const T v = x[j];
+            const T e = math_exp(v > mx[l] ? mx[l] - v : v - mx[l], m);
+            sm[l] = v > mx[l] ? sm[l] * e + 1 : sm[l] + e;
+            mx[l] = v > mx[l] ? v : mx[l];
+        }
+
+        T max_val = mx[0];
+        for (size_t l = 1; l < LANES; ++l) {
+            max_val = mx[l] > max_val ? mx[l] : max_val;
+        }
+        T sum = 0;
+        for (size_t l = 0; l < LANES; ++l) {
+            sum += sm[l] * math_exp(mx[l] - max_val, m);
+        }
+        max_out = max_val;
+        sum_out = sum;
+    }
+
+    static void run(size_t rows, size_t cols, const T* src, T* dst) {
+        with_math_mode([&](auto m) {
+            #pragma omp parallel for schedule(static) if(parallel_dispatch::use_parallel(parallel_op::transcendental, rows * cols))
+            for (size_t i = 0; i < rows; ++i) {
+                const T* x = src + i * cols;
+                T* y = dst + i * cols;
+                T max_val, sum;
+                max_sum(x, cols, max_val, sum, m);
+                const T inv = 1 / sum;
+                #pragma omp simd
+                for (size_t j = 0; j < cols; ++j) {
+                    y[j] = math_exp(x[j] - max_val, m) * inv;
+                }
+            }
+        });
+    }
+
+    // grad = softmax(logits) - labels, returns sum over rows of
+    // -sum_j labels[j] * log(softmax(logits)[j]).
+    static T cross_entropy(size_t rows, size_t cols, const T* logits, const T* labels, T* grad) {
+        // per-row losses are summed by reduce_kernel, the total does not
+        // depend on the thread count
+        std::vector<T> row_losses(rows);
+        with_math_mode([&](auto m) {
+            #pragma omp parallel for schedule(static) if(parallel_dispatch::use_parallel(parallel_op::transcendental, rows * cols))
+            for (size_t i = 0; i < rows; ++i) {
+                const T* x = logits + i * cols;
+                const T* t = labels + i * cols;
+                T* g = grad + i * cols;
+                T max_val, sum;
+                max_sum(x, cols, max_val, sum, m);
+                const T inv = 1 / sum;
+                const T log_norm = max_val + std::log(sum);
+                T row_loss = 0;
+                #pragma omp simd reduction(+:row_loss)
+                for (size_t j = 0; j < cols; ++j) {
+                    g[j] = math_exp(x[j] - max_val, m) * inv - t[j];
+                    row_loss += t[j] * (log_norm - x[j]);
+                }
+                row_losses[i] = row_loss;
+            }
+        });
+        return reduce_kernel<T>::sum(rows, [&](size_t i) { return row_losses[i]; });
+    }
+};
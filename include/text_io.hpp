@@ -0,0 +1,327 @@
+/* text_io.hpp - Bulk text formatting and parsing for matrix.hpp */
+/* by ValKmjolnir 2026/10/17 */
+
+#pragma once
+
+#include "parallel.hpp"
+
+#include <omp.h>
+
+#include <algorithm>
+#include <charconv>
+#include <cstddef>
+#include <istream>
+#include <limits>
+#include <memory>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <vector>
+
+// Text matrices: numbers separated by whitespace or commas, one row per line
+// when written. Numbers are formatted with std::to_chars in the shortest form
+// that reads back to the same value, and parsed with std::from_chars, so
+// neither side goes through the stream locale or formatting flags.
+//
+// Writing formats chunks of CHUNK elements in parallel and hands each one
+// to the stream in a single write. Reading cuts a block of text into pieces
+// at separators, counts the numbers of every piece, and then parses the
+// pieces in parallel, each one starting at its known element index.
+template<typename T>
+struct text_codec {
+    static constexpr size_t CHUNK = 1 << 14;
+    // one number in shortest form ("-d.ddde-ddddd") plus separator
+    static constexpr size_t MAX_CHARS = std::numeric_limits<T>::max_digits10 + 12;
+    static constexpr size_t READ_BLOCK = 1 << 22;
+
+    static bool is_separator(char c) {
+        return c == ' ' || c == ',' || c == '\n' || c == '\r' || c == '\t' || c == '\f' || c == '\v';
+    }
+
+private:
+    // Start of the next piece: the first separator at or after p.
+    static const char* next_cut(const char* p, const char* end, bool at_newline) {
+        while (p < end && (at_newline ? *p != '\n' : !is_separator(*p)))
+            ++p;
+        return p;
+    }
+
+    static std::vector<const char*> split(const char* begin, const char* end, size_t pieces, bool at_newline) {
+        std::vector<const char*> cut(pieces + 1, end);
+        cut[0] = begin;
+        const size_t length = end - begin;
+        for (size_t k = 1; k < pieces; ++k)
+            cut[k] = next_cut(std::max(cut[k - 1], begin + length * k / pieces), end, at_newline);
+        return cut;
+    }
+
+    static size_t pieces_for(size_t length) {
+        // about 8 characters per number
+        return parallel_dispatch::use_parallel(parallel_op::transcendental, length / 8)
+            ? static_cast<size_t>(omp_get_max_threads()) * 4
+            : 1;
+    }
+
+    static size_t count_numbers(const char* p, const char* end) {
+        size_t count = 0;
+        bool in_number = false;
+        for (; p < end; ++p) {
+            const bool sep = is_separator(*p);
+            count += !sep && !in_number;
+            in_number = !sep;
+        }
+        return count;
+    }
+
+    // std::from_chars without the leading '+' it rejects and operator>>
+    // on a float accepts ("+1.5", but not "+-1").
+    static std::from_chars_result parse_number(const char* p, const char* end, T& value) {
+        if (end - p > 1 && *p == '+' && p[1] != '+' && p[1] != '-') {
+            ++p;
+        }
+        return std::from_chars(p, end, value);
+    }
+
+    [[noreturn]] static void report_token(const char* p, const char* end) {
+        const char* q = p;
+        while (q < end && !is_separator(*q) && q - p < 32)
+            ++q;
+        throw std::runtime_error("Error: cannot parse \"" + std::string(p, q) + "\" as a number.");
+    }
+
+    // Parses at most n numbers of [p, end) into dst. Returns the end of the
+    // last number parsed, or where the bad token starts in *error.
+    static const char* parse_piece(const char* p, const char* end, T* dst, size_t n, size_t& parsed,
+                                   const char** error) {
+        parsed = 0;
+        while (parsed < n) {
+            while (p < end && is_separator(*p))
+                ++p;
+            if (p == end) {
+                break;
+            }
+            const std::from_chars_result r = parse_number(p, end, dst[parsed]);
+            if (r.ec != std::errc() || (r.ptr != end && !is_separator(*r.ptr))) {
+                *error = p;
+                break;
+            }
+            p = r.ptr;
+            ++parsed;
+        }
+        return p;
+    }
+
+    // formats data[begin, end) into text, returns the length
+    static size_t format_range(const T* data, size_t begin, size_t end, size_t cols, char sep, char* text) {
+        char* p = text;
+        char* const last = text + (end - begin) * MAX_CHARS;
+        size_t c = begin % cols;
+        for (size_t i = begin; i < end; ++i) {
+            p = std::to_chars(p, last, data[i]).ptr;
+            *p++ = ++c == cols ? '\n' : sep;
+            c = c == cols ? 0 : c;
+        }
+        return p - text;
+    }
+
+public:
+    // rows x cols numbers of data, row-major, one row per line
+    static void write(std::ostream& out, const T* data, size_t rows, size_t cols, char sep = ' ') {
+        const size_t n = rows * cols;
+        const size_t chunks = (n + CHUNK - 1) / CHUNK;
+        const bool parallel = parallel_dispatch::use_parallel(parallel_op::transcendental, n);
+        // two chunks per thread and round, the buffer is never cleared
+        const size_t batch = std::min(chunks, parallel ? 2 * static_cast<size_t>(omp_get_max_threads()) : 1);
+        const size_t room = std::min(n, CHUNK) * MAX_CHARS;
+        std::unique_ptr<char[]> text(new char[batch * room]);
+        std::vector<size_t> length(batch);
+        for (size_t first = 0; first < chunks; first += batch) {
+            const size_t count = std::min(batch, chunks - first);
+            #pragma omp parallel for schedule(static) if(parallel && count > 1)
+            for (size_t c = 0; c < count; ++c) {
+                const size_t begin = (first + c) * CHUNK;
+                length[c] = format_range(data, begin, std::min(n, begin + CHUNK), cols, sep, text.get() + c * room);
+            }
+            for (size_t c = 0; c < count; ++c)
+                out.write(text.get() + c * room, length[c]);
+        }
+    }
+
+    // Parses up to n numbers of [begin, end) into dst and returns how many
+    // were found. *stop is set to the end of the last number parsed.
+    static size_t parse(const char* begin, const char* end, T* dst, size_t n, const char** stop = nullptr) {
+        const size_t pieces = pieces_for(end - begin);
+        const std::vector<const char*> cut = split(begin, end, pieces, false);
+
+        std::vector<size_t> first(pieces + 1, 0);
+        #pragma omp parallel for schedule(static) if(pieces > 1)
+        for (size_t k = 0; k < pieces; ++k)
+            first[k + 1] = count_numbers(cut[k], cut[k + 1]);
+        for (size_t k = 0; k < pieces; ++k)
+            first[k + 1] += first[k];
+
+        std::vector<const char*> piece_end(pieces, nullptr);
+        std::vector<const char*> error(pieces, nullptr);
+        #pragma omp parallel for schedule(static) if(pieces > 1)
+        for (size_t k = 0; k < pieces; ++k) {
+            if (first[k] < n) {
+                size_t parsed;
+                piece_end[k] = parse_piece(cut[k], cut[k + 1], dst + first[k],
+                                           std::min(n, first[k + 1]) - first[k], parsed, &error[k]);
+            }
+        }
+        for (size_t k = 0; k < pieces; ++k) {
+            if (error[k]) {
+                report_token(error[k], end);
+            }
+        }
+
+        const size_t found = std::min(n, first[pieces]);
+        if (stop) {
+            *stop = begin;
+            for (size_t k = 0; k < pieces; ++k) {
+                if (piece_end[k] && first[k] < found) {
+                    *stop = piece_end[k];
+                }
+            }
+        }
+        return found;
+    }
+
+    // Reads n numbers from in into dst and returns how many were found.
+    // Seekable streams are read in large blocks and rewound to just after
+    // the last number; others are read one number at a time, so the rest
+    // of the stream is left untouched either way.
+    static size_t read(std::istream& in, T* dst, size_t n) {
+        if (!n) {
+            return 0;
+        }
+        if (in.tellg() < 0) {
+            return read_unbuffered(in, dst, n);
+        }
+
+        std::string buffer;
+        size_t done = 0;
+        while (done < n && in) {
+            const size_t kept = buffer.size();
+            buffer.resize(kept + READ_BLOCK);
+            in.read(&buffer[kept], READ_BLOCK);
+            buffer.resize(kept + static_cast<size_t>(in.gcount()));
+            const bool last = !in;
+
+            // a number cut by the block boundary waits for the next block
+            const char* begin = buffer.data();
+            const char* end = begin + buffer.size();
+            const char* cut = end;
+            if (!last) {
+                while (cut > begin && !is_separator(cut[-1]))
+                    --cut;
+            }
+
+            const char* stop = begin;
+            done += parse(begin, cut, dst + done, n - done, &stop);
+            if (done == n) {
+                const std::streamoff unread = end - stop;
+                in.clear(last ? std::ios::eofbit : std::ios::goodbit);
+                if (unread) {
+                    in.clear();
+                    in.seekg(-unread, std::ios::cur);
+                }
+                return done;
+            }
+            buffer.erase(0, cut - begin);
+        }
+        return done;
+    }
+
+    // All numbers of the rest of in, one row per non-empty line; every row
+    // must have the same count. The numbers are parsed into
+    // alloc(rows, cols), which returns room for rows * cols of T.
+    template<typename Alloc>
+    static void read_all(std::istream& in, Alloc&& alloc) {
+        std::string text;
+        const std::streampos here = in.tellg();
+        if (here >= 0 && in.seekg(0, std::ios::end)) {
+            text.resize(static_cast<size_t>(in.tellg() - here));
+            in.seekg(here);
+            in.read(&text[0], text.size());
+        }
+        while (in) {
+            const size_t kept = text.size();
+            text.resize(kept + READ_BLOCK);
+            in.read(&text[kept], READ_BLOCK);
+            text.resize(kept + static_cast<size_t>(in.gcount()));
+        }
+        in.clear(std::ios::eofbit);
+
+        const char* begin = text.data();
+        const char* end = begin + text.size();
+        const size_t pieces = pieces_for(text.size());
+        const std::vector<const char*> cut = split(begin, end, pieces, true);
+
+        // numbers per line of every piece, 0 when they differ
+        const size_t mixed = static_cast<size_t>(-1);
+        std::vector<size_t> line_width(pieces, 0), piece_rows(pieces, 0);
+        #pragma omp parallel for schedule(static) if(pieces > 1)
+        for (size_t k = 0; k < pieces; ++k) {
+            const char* p = cut[k];
+            while (p < cut[k + 1]) {
+                const char* eol = std::find(p, cut[k + 1], '\n');
+                const size_t width = count_numbers(p, eol);
+                if (width) {
+                    line_width[k] = !line_width[k] || line_width[k] == width ? width : mixed;
+                    ++piece_rows[k];
+                }
+                p = eol + (eol < cut[k + 1]);
+            }
+        }
+
+        size_t rows = 0;
+        size_t cols = 0;
+        for (size_t k = 0; k < pieces; ++k) {
+            if (!line_width[k]) {
+                continue;
+            }
+            if (line_width[k] == mixed || (cols && cols != line_width[k])) {
+                throw std::runtime_error("Error: rows of the text matrix have different lengths.");
+            }
+            cols = line_width[k];
+            rows += piece_rows[k];
+        }
+
+        T* dst = alloc(rows, cols);
+        parse(begin, end, dst, rows * cols);
+    }
+
+private:
+    static size_t read_unbuffered(std::istream& in, T* dst, size_t n) {
+        std::streambuf* sb = in.rdbuf();
+        // whole tokens, however long, so a long number is never split in two
+        std::string token;
+        size_t done = 0;
+        for (; done < n; ++done) {
+            int c = sb->sgetc();
+            while (c != std::char_traits<char>::eof() && is_separator(static_cast<char>(c)))
+                c = sb->snextc();
+            token.clear();
+            while (c != std::char_traits<char>::eof() && !is_separator(static_cast<char>(c))) {
+                token += static_cast<char>(c);
+                c = sb->snextc();
+            }
+            if (c == std::char_traits<char>::eof()) {
+                in.setstate(std::ios::eofbit);
+            }
+            if (token.empty()) {
+                break;
+            }
+            const char* const end = token.data() + token.size();
+            const std::from_chars_result r = parse_number(token.data(), end, dst[done]);
+            if (r.ec != std::errc() || r.ptr != end) {
+                report_token(token.data(), end);
+            }
+        }
+        return done;
+    }
+};
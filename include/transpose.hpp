@@ -0,0 +1,234 @@
+/* transpose.hpp - Tiled SIMD transpose kernels used by matrix.hpp */
+/* by ValKmjolnir 2026/10/17 */
+
+#pragma once
+
+#include "parallel.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#if defined(__AVX__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+// Transposes one B x B block held in registers:
+// dst[j * ldd + i] = src[i * lds + j] for i, j < B.
+// src and dst must not overlap.
+template<typename T>
+struct transpose_block {
+    static constexpr size_t B = 4;
+
+    static void run(const T* src, size_t lds, T* dst, size_t ldd) {
+        for (size_t i = 0; i < B; ++i)
+            for (size_t j = 0; j < B; ++j)
+                dst[j * ldd + i] = src[i * lds + j];
+    }
+};
+
+#if defined(__AVX__)
+template<>
+struct transpose_block<float> {
+    static constexpr size_t B = 8;
+
+    static void run(const float* src, size_t lds, float* dst, size_t ldd) {
+        __m256 r0 = _mm256_loadu_ps(src + 0 * lds);
+        __m256 r1 = _mm256_loadu_ps(src + 1 * lds);
+        __m256 r2 = _mm256_loadu_ps(src + 2 * lds);
+        __m256 r3 = _mm256_loadu_ps(src + 3 * lds);
+        __m256 r4 = _mm256_loadu_ps(src + 4 * lds);
+        __m256 r5 = _mm256_loadu_ps(src + 5 * lds);
+        __m256 r6 = _mm256_loadu_ps(src + 6 * lds);
+        __m256 r7 = _mm256_loadu_ps(src + 7 * lds);
+
+        // interleave pairs of rows
+        __m256 t0 = _mm256_unpacklo_ps(r0, r1);
+        __m256 t1 = _mm256_unpackhi_ps(r0, r1);
+        __m256 t2 = _mm256_unpacklo_ps(r2, r3);
+        __m256 t3 = _mm256_unpackhi_ps(r2, r3);
+        __m256 t4 = _mm256_unpacklo_ps(r4, r5);
+        __m256 t5 = _mm256_unpackhi_ps(r4, r5);
+        __m256 t6 = _mm256_unpacklo_ps(r6, r7);
+        __m256 t7 = _mm256_unpackhi_ps(r6, r7);
+
+        // 4x4 transposes inside each 128-bit lane
+        r0 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0));
+        r1 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+        r2 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0));
+        r3 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
+        r4 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(1, 0, 1, 0));
+        r5 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(3, 2, 3, 2));
+        r6 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(1, 0, 1, 0));
+        r7 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(3, 2, 3, 2));
+
+        // swap the upper lanes of the top half with the lower lanes of the bottom half
+        _mm256_storeu_ps(dst + 0 * ldd, _mm256_permute2f128_ps(r0, r4, 0x20));
+        _mm256_storeu_ps(dst + 1 * ldd, _mm256_permute2f128_ps(r1, r5, 0x20));
+        _mm256_storeu_ps(dst + 2 * ldd, _mm256_permute2f128_ps(r2, r6, 0x20));
+        _mm256_storeu_ps(dst + 3 * ldd, _mm256_permute2f128_ps(r3, r7, 0x20));
+        _mm256_storeu_ps(dst + 4 * ldd, _mm256_permute2f128_ps(r0, r4, 0x31));
+        _mm256_storeu_ps(dst + 5 * ldd, _mm256_permute2f128_ps(r1, r5, 0x31));
+        _mm256_storeu_ps(dst + 6 * ldd, _mm256_permute2f128_ps(r2, r6, 0x31));
+        _mm256_storeu_ps(dst + 7 * ldd, _mm256_permute2f128_ps(r3, r7, 0x31));
+    }
+};
+
+template<>
+struct transpose_block<double> {
+    static constexpr size_t B = 4;
+
+    static void run(const double* src, size_t lds, double* dst, size_t ldd) {
+        const __m256d r0 = _mm256_loadu_pd(src + 0 * lds);
+        const __m256d r1 = _mm256_loadu_pd(src + 1 * lds);
+        const __m256d r2 = _mm256_loadu_pd(src + 2 * lds);
+        const __m256d r3 = _mm256_loadu_pd(src + 3 * lds);
+
+        const __m256d t0 = _mm256_unpacklo_pd(r0, r1);
+        const __m256d t1 = _mm256_unpackhi_pd(r0, r1);
+        const __m256d t2 = _mm256_unpacklo_pd(r2, r3);
+        const __m256d t3 = _mm256_unpackhi_pd(r2, r3);
+
+        _mm256_storeu_pd(dst + 0 * ldd, _mm256_permute2f128_pd(t0, t2, 0x20));
+        _mm256_storeu_pd(dst + 1 * ldd, _mm256_permute2f128_pd(t1, t3, 0x20));
+        _mm256_storeu_pd(dst + 2 * ldd, _mm256_permute2f128_pd(t0, t2, 0x31));
+        _mm256_storeu_pd(dst + 3 * ldd, _mm256_permute2f128_pd(t1, t3, 0x31));
+    }
+};
+#elif defined(__SSE2__)
+template<>
+struct transpose_block<float> {
+    static constexpr size_t B = 4;
+
+    static void run(const float* src, size_t lds, float* dst, size_t ldd) {
+        __m128 r0 = _mm_loadu_ps(src + 0 * lds);
+        __m128 r1 = _mm_loadu_ps(src + 1 * lds);
+        __m128 r2 = _mm_loadu_ps(src + 2 * lds);
+        __m128 r3 = _mm_loadu_ps(src + 3 * lds);
+        _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+        _mm_storeu_ps(dst + 0 * ldd, r0);
+        _mm_storeu_ps(dst + 1 * ldd, r1);
+        _mm_storeu_ps(dst + 2 * ldd, r2);
+        _mm_storeu_ps(dst + 3 * ldd, r3);
+    }
+};
+
+template<>
+struct transpose_block<double> {
+    static constexpr size_t B = 2;
+
+    static void run(const double* src, size_t lds, double* dst, size_t ldd) {
+        const __m128d r0 = _mm_loadu_pd(src);
+        const __m128d r1 = _mm_loadu_pd(src + lds);
+        _mm_storeu_pd(dst, _mm_unpacklo_pd(r0, r1));
+        _mm_storeu_pd(dst + ldd, _mm_unpackhi_pd(r0, r1));
+    }
+};
+#endif
+
+// Out-of-place and in-place transposes of row-major storage.
+//
+// The matrix is cut into TILE x TILE tiles, small enough that a source and a
+// destination tile both stay in L1, and each tile is transposed with register
+// blocks. Strided writes then touch only TILE rows at a time instead of
+// walking the whole destination column and missing the TLB on every element.
+template<typename T>
+struct transpose_kernel {
+    static constexpr size_t B = transpose_block<T>::B;
+    static constexpr size_t TILE = 256 / sizeof(T);
+
+private:
+    // one tile, split into register blocks plus scalar edges
+    static void tile(size_t rows, size_t cols, const T* src, size_t lds, T* dst, size_t ldd) {
+        const size_t rb = rows / B * B;
+        const size_t cb = cols / B * B;
+        for (size_t i = 0; i < rb; i += B) {
+            for (size_t j = 0; j < cb; j += B) {
+                transpose_block<T>::run(src + i * lds + j, lds, dst + j * ldd + i, ldd);
+            }
+            for (size_t ii = i; ii < i + B; ++ii)
+                for (size_t j = cb; j < cols; ++j)
+                    dst[j * ldd + ii] = src[ii * lds + j];
+        }
+        for (size_t i = rb; i < rows; ++i)
+            for (size_t j = 0; j < cols; ++j)
+                dst[j * ldd + i] = src[i * lds + j];
+    }
+
+    // Swaps the B x B blocks at (i, j) and (j, i) through registers.
+    // Diagonal blocks (i == j) are transposed onto themselves.
+    static void swap_blocks(T* a, size_t n, size_t i, size_t j) {
+        T tmp[B * B];
+        transpose_block<T>::run(a + j * n + i, n, tmp, B);
+        if (i != j) {
+            transpose_block<T>::run(a + i * n + j, n, a + j * n + i, n);
+        }
+        for (size_t r = 0; r < B; ++r)
+            std::copy(tmp + r * B, tmp + r * B + B, a + (i + r) * n + j);
+    }
+
+public:
+    // dst (cols x rows, leading dimension ldd) = src (rows x cols, leading dimension lds)^T
+    static void run(size_t rows, size_t cols, const T* src, size_t lds, T* dst, size_t ldd) {
+        const size_t row_tiles = (rows + TILE - 1) / TILE;
+        const size_t col_tiles = (cols + TILE - 1) / TILE;
+        #pragma omp parallel for collapse(2) schedule(static) if(parallel_dispatch::use_parallel(parallel_op::copy, rows * cols))
+        for (size_t ti = 0; ti < row_tiles; ++ti) {
+            for (size_t tj = 0; tj < col_tiles; ++tj) {
+                const size_t i0 = ti * TILE;
+                const size_t j0 = tj * TILE;
+                tile(std::min(TILE, rows - i0), std::min(TILE, cols - j0),
+                     src + i0 * lds + j0, lds, dst + j0 * ldd + i0, ldd);
+            }
+        }
+    }
+
+    // In-place transpose of an n x n matrix. Tile pairs above and below the
+    // diagonal are swapped block by block, each tile pair by one thread.
+    static void square_inplace(size_t n, T* a) {
+        const size_t nb = n / B * B;
+        const size_t tiles = (nb + TILE - 1) / TILE;
+        #pragma omp parallel for schedule(dynamic) if(parallel_dispatch::use_parallel(parallel_op::copy, n * n))
+        for (size_t ti = 0; ti < tiles; ++ti) {
+            const size_t i_end = std::min(nb, (ti + 1) * TILE);
+            for (size_t tj = ti; tj < tiles; ++tj) {
+                const size_t j_end = std::min(nb, (tj + 1) * TILE);
+                for (size_t i = ti * TILE; i < i_end; i += B)
+                    for (size_t j = ti == tj ? i : tj * TILE; j < j_end; j += B)
+                        swap_blocks(a, n, i, j);
+            }
+        }
+        // ragged border: rows nb..n against columns 0..n
+        for (size_t i = nb; i < n; ++i)
+            for (size_t j = 0; j < i; ++j)
+                std::swap(a[i * n + j], a[j * n + i]);
+    }
+
+    // In-place transpose of a rows x cols matrix into cols x rows by
+    // following the cycles of the permutation i -> i * rows mod (N - 1).
+    // Needs one bit per element to mark visited positions instead of a
+    // second copy of the data.
+    static void rect_inplace(size_t rows, size_t cols, T* a) {
+        const size_t size = rows * cols;
+        if (rows <= 1 || cols <= 1) {
+            return;
+        }
+        const size_t last = size - 1;
+        std::vector<bool> visited(size, false);
+        for (size_t start = 1; start < last; ++start) {
+            if (visited[start]) {
+                continue;
+            }
+            // element at `start` belongs at start * rows mod last
+            T carry = a[start];
+            size_t pos = start;
+            do {
+                const size_t next = pos * rows % last;
+                std::swap(carry, a[next]);
+                visited[next] = true;
+                pos = next;
+            } while (pos != start);
+        }
+    }
+};
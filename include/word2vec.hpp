@@ -3,8 +3,13 @@
 
 #pragma once
 
+#include "alias_table.hpp"
+#include "corpus.hpp"
 #include "matrix.hpp"
 
+#include <omp.h>
+
+#include <atomic>
 #include <string>
 #include <vector>
 #include <unordered_map>
@@ -16,6 +21,75 @@
 #include <cmath>
 #include <cstdint>
 
+// Row kernels and lookup tables of the skip-gram update, on raw rows of
+// length n with simd_reg from gemm.hpp.
+template<typename T>
+struct skip_gram_kernel {
+    // sigmoid and log(sigmoid) sampled on [-MAX_EXP, MAX_EXP]
+    static constexpr int TABLE_SIZE = 1024;
+    static constexpr T MAX_EXP = 6;
+
+    static T dot(const T* a, const T* b, size_t n) {
+        using V = simd_reg<T>;
+        constexpr size_t W = V::width;
+        typename V::reg acc0 = V::zero(), acc1 = V::zero();
+        size_t i = 0;
+        for (; i + 2 * W <= n; i += 2 * W) {
+            acc0 = V::fmadd(V::loadu(a + i), V::loadu(b + i), acc0);
+            acc1 = V::fmadd(V::loadu(a + i + W), V::loadu(b + i + W), acc1);
+        }
+        for (; i + W <= n; i += W)
+            acc0 = V::fmadd(V::loadu(a + i), V::loadu(b + i), acc0);
+        T lanes[2 * W];
+        V::storeu(lanes, acc0);
+        V::storeu(lanes + W, acc1);
+        T result = 0;
+        for (size_t l = 0; l < 2 * W; ++l)
+            result += lanes[l];
+        for (; i < n; ++i)
+            result += a[i] * b[i];
+        return result;
+    }
+
+    // y += g * x
+    static void axpy(T g, const T* x, T* y, size_t n) {
+        using V = simd_reg<T>;
+        constexpr size_t W = V::width;
+        const typename V::reg gv = V::broadcast(g);
+        size_t i = 0;
+        for (; i + W <= n; i += W)
+            V::storeu(y + i, V::fmadd(gv, V::loadu(x + i), V::loadu(y + i)));
+        for (; i < n; ++i)
+            y[i] += g * x[i];
+    }
+
+    static const T* tables() {
+        static const std::vector<T> table = [] {
+            std::vector<T> t(2 * (TABLE_SIZE + 1));
+            for (int i = 0; i <= TABLE_SIZE; ++i) {
+                const double x = (2.0 * i / TABLE_SIZE - 1) * MAX_EXP;
+                t[i] = static_cast<T>(1 / (1 + std::exp(-x)));
+                t[TABLE_SIZE + 1 + i] = static_cast<T>(-std::log1p(std::exp(-x)));
+            }
+            return t;
+        }();
+        return table.data();
+    }
+
+    static int index(T x) {
+        return static_cast<int>((x + MAX_EXP) * (TABLE_SIZE / (2 * MAX_EXP)) + T(0.5));
+    }
+
+    static T sigmoid(T x) {
+        return x >= MAX_EXP ? 1 : x <= -MAX_EXP ? 0 : tables()[index(x)];
+    }
+
+    // log(sigmoid(x)), about 0 above the table and x below it
+    static T log_sigmoid(T x) {
+        return x >= MAX_EXP ? 0 : x <= -MAX_EXP ? x : tables()[TABLE_SIZE + 1 + index(x)];
+    }
+};
+
 template<typename T = float>
 class Word2Vec {
     static_assert(std::is_floating_point<T>::value, "T must be floating point type");
@@ -30,12 +104,16 @@ public:
         T min_count = 1;
         T subsample_threshold = 1e-3f;
         bool use_negative_sampling = true;
+        size_t threads = 0;                 // 0: omp_get_max_threads()
+        T min_learning_rate_ratio = 1e-4f;  // floor of the linear decay
+        T negative_power = 0.75f;           // negatives drawn by count^power
+        bool shared_negatives = false;      // one negative set per window, updated with GEMMs
     };
 
 private:
     std::unordered_map<std::string, size_t> word2idx;
     std::vector<std::string> idx2word;
-    std::unordered_map<std::string, size_t> word_counts;
+    std::vector<size_t> idx_counts;  // corpus count of every vocabulary word
     size_t vocab_size = 0;
     size_t total_words = 0;
 
@@ -45,44 +123,53 @@ private:
     TrainingConfig config;
     std::mt19937 rng;
 
-    std::vector<std::string> corpus;
-    std::vector<std::vector<size_t>> sentences;
+    // The corpus as ids of dictionary, and after subsampling as vocabulary
+    // ids, sentence s being stream[sentence_offset[s], sentence_offset[s + 1]).
+    token_dictionary dictionary;
+    std::vector<uint32_t> tokens;
+    std::vector<uint32_t> stream;
+    std::vector<size_t> sentence_offset;
+    std::vector<T> epoch_losses;
+    alias_table negative_table;
 
 private:
-    void build_vocabulary() {
+    // Vocabulary id of every dictionary id, NONE below min_count. Ids keep
+    // the order of first appearance.
+    std::vector<uint32_t> build_vocabulary() {
         word2idx.clear();
         idx2word.clear();
+        idx_counts.clear();
         vocab_size = 0;
 
-        for (const auto& word : corpus) {
-            if (word_counts[word] >= config.min_count) {
-                if (word2idx.find(word) == word2idx.end()) {
-                    word2idx[word] = vocab_size;
-                    idx2word.push_back(word);
-                    vocab_size++;
-                }
+        std::vector<uint32_t> vocab_id(dictionary.size(), token_dictionary::NONE);
+        for (uint32_t id = 0; id < dictionary.size(); ++id) {
+            if (dictionary.count(id) >= config.min_count) {
+                vocab_id[id] = static_cast<uint32_t>(vocab_size);
+                word2idx[dictionary.word(id)] = vocab_size;
+                idx2word.push_back(dictionary.word(id));
+                idx_counts.push_back(dictionary.count(id));
+                vocab_size++;
             }
         }
+        return vocab_id;
     }
 
-    T get_subsample_prob(const std::string& word) const {
+    T get_subsample_prob(size_t idx) const {
         if (total_words == 0) return 0.0f;
-        T freq = static_cast<T>(word_counts.at(word)) / static_cast<T>(total_words);
+        T freq = static_cast<T>(idx_counts[idx]) / static_cast<T>(total_words);
         return 1.0f - std::sqrt(config.subsample_threshold / freq);
     }
 
-    std::vector<size_t> generate_negative_samples(size_t target_idx, size_t n_samples) {
-        std::vector<size_t> negatives;
-        std::uniform_int_distribution<size_t> dist(0, vocab_size - 1);
-
-        for (size_t i = 0; i < n_samples; ++i) {
-            size_t neg_idx;
-            do {
-                neg_idx = dist(rng);
-            } while (neg_idx == target_idx);
-            negatives.push_back(neg_idx);
-        }
-        return negatives;
+    // Unigram counts of the vocabulary raised to negative_power. Words
+    // without a count (vocabulary from load_embeddings) weigh as one.
+    void build_negative_table() {
+        std::vector<double> counts(vocab_size, 1);
+        for (size_t i = 0; i < idx_counts.size(); ++i)
+            counts[i] = static_cast<double>(idx_counts[i]);
+        negative_table.build(counts, config.negative_power);
+        std::cout << "Negative sampler: " << negative_table.size() << " words, "
+                  << negative_table.memory_bytes() / 1024.0 << " KiB, built in "
+                  << negative_table.build_seconds() * 1e3 << " ms" << std::endl;
     }
 
 public:
@@ -95,63 +182,50 @@ public:
         if (context_embeddings) delete context_embeddings;
     }
 
+    // Replaces the corpus. Words are lowercased letters, see corpus.hpp.
     void load_corpus(const std::string& text) {
-        corpus.clear();
-        std::istringstream iss(text);
-        std::string word;
-
-        while (iss >> word) {
-            // Simple tokenization: convert to lowercase and remove non-alpha
-            std::string cleaned;
-            for (char c : word) {
-                if (std::isalpha(static_cast<unsigned char>(c))) {
-                    cleaned += static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
-                }
-            }
-            if (!cleaned.empty()) {
-                corpus.push_back(cleaned);
-                word_counts[cleaned]++;
-                total_words++;
-            }
-        }
+        dictionary.clear();
+        tokens.clear();
+        total_words = corpus_tokenizer::append(text.data(), text.data() + text.size(), dictionary, tokens);
     }
 
+    // Same as load_corpus(), streamed from a mapped file; only the token
+    // ids and the dictionary are kept in memory.
     void load_corpus_from_file(const std::string& filepath) {
-        std::ifstream file(filepath);
-        if (!file.is_open()) {
-            throw std::runtime_error("Cannot open file: " + filepath);
-        }
-
-        std::stringstream buffer;
-        buffer << file.rdbuf();
-        load_corpus(buffer.str());
+        dictionary.clear();
+        tokens.clear();
+        total_words = corpus_tokenizer::append_file(filepath, dictionary, tokens);
     }
 
-    void prepare_training_data() {
-        build_vocabulary();
-
-        // Apply subsampling and convert to indices
-        sentences.clear();
-        std::vector<size_t> current_sentence;
-
-        for (const auto& word : corpus) {
-            if (word2idx.find(word) == word2idx.end()) continue;
+    size_t get_corpus_size() const { return tokens.size(); }
 
-            // Subsampling
-            T prob = get_subsample_prob(word);
-            std::uniform_real_distribution<T> dist(0.0f, 1.0f);
+    void prepare_training_data() {
+        MATRIX_PROFILE_SCOPE("w2v_prepare", 0, 0);
+        const std::vector<uint32_t> vocab_id = build_vocabulary();
+        if (vocab_size) {
+            build_negative_table();
+        }
 
-            if (prob > dist(rng)) {
-                current_sentence.push_back(word2idx[word]);
-            } else {
-                if (!current_sentence.empty()) {
-                    sentences.push_back(current_sentence);
-                    current_sentence.clear();
-                }
+        std::vector<T> keep(vocab_size);
+        for (size_t i = 0; i < vocab_size; ++i)
+            keep[i] = get_subsample_prob(i);
+
+        // Apply subsampling, a dropped word ends the sentence
+        stream.clear();
+        sentence_offset.assign(1, 0);
+        std::uniform_real_distribution<T> dist(0.0f, 1.0f);
+        for (const uint32_t token : tokens) {
+            const uint32_t idx = vocab_id[token];
+            if (idx == token_dictionary::NONE) continue;
+
+            if (keep[idx] > dist(rng)) {
+                stream.push_back(idx);
+            } else if (stream.size() > sentence_offset.back()) {
+                sentence_offset.push_back(stream.size());
             }
         }
-        if (!current_sentence.empty()) {
-            sentences.push_back(current_sentence);
+        if (stream.size() > sentence_offset.back()) {
+            sentence_offset.push_back(stream.size());
         }
     }
 
@@ -160,6 +234,7 @@ public:
             throw std::runtime_error("Vocabulary not built. Call prepare_training_data() first.");
         }
 
+        MATRIX_PROFILE_SCOPE("w2v_init", 0, 2 * sizeof(T) * vocab_size * config.embedding_dim);
         if (word_embeddings) delete word_embeddings;
         if (context_embeddings) delete context_embeddings;
 
@@ -167,118 +242,247 @@ public:
         context_embeddings = new matrix<T>(vocab_size, config.embedding_dim);
 
         // Initialize with small random values
-        std::uniform_real_distribution<T> dist(-0.5f / config.embedding_dim, 0.5f / config.embedding_dim);
-
-        for (size_t i = 0; i < vocab_size; ++i) {
-            for (size_t j = 0; j < config.embedding_dim; ++j) {
-                (*word_embeddings)[i][j] = dist(rng);
-                (*context_embeddings)[i][j] = dist(rng);
-            }
-        }
+        const T limit = 0.5f / config.embedding_dim;
+        word_embeddings->random_uniform(-limit, limit, rng());
+        context_embeddings->random_uniform(-limit, limit, rng());
     }
 
-    void train() {
-        if (!word_embeddings || !context_embeddings) {
-            initialize_embeddings();
-        }
-
-        std::uniform_int_distribution<size_t> neg_dist(0, vocab_size - 1);
-
-        for (size_t epoch = 0; epoch < config.epochs; ++epoch) {
-            T total_loss = 0.0f;
-            size_t total_pairs = 0;
-
-            for (const auto& sentence : sentences) {
-                for (size_t pos = 0; pos < sentence.size(); ++pos) {
-                    size_t target_idx = sentence[pos];
-
-                    // Generate context window
-                    size_t window_start = (pos > config.window_size) ? (pos - config.window_size) : 0;
-                    size_t window_end = std::min(pos + config.window_size + 1, sentence.size());
-
-                    for (size_t ctx_pos = window_start; ctx_pos < window_end; ++ctx_pos) {
-                        if (ctx_pos == pos) continue;
-
-                        size_t context_idx = sentence[ctx_pos];
+private:
+    // tokens trained by all threads, drives the learning rate decay
+    struct train_progress {
+        std::atomic<size_t> words{0};
+        size_t total = 0;
+    };
 
-                        if (config.use_negative_sampling) {
-                            // Negative sampling loss
-                            auto neg_samples = generate_negative_samples(target_idx, config.negative_samples);
+    static constexpr size_t PROGRESS_STEP = 10000;
 
-                            // Positive sample gradient
-                            matrix<T> target_emb(1, config.embedding_dim);
-                            matrix<T> context_emb(1, config.embedding_dim);
+    T learning_rate_at(size_t words_done, size_t total) const {
+        const T left = 1 - static_cast<T>(words_done) / static_cast<T>(total + 1);
+        return config.learning_rate * std::max(left, config.min_learning_rate_ratio);
+    }
 
-                            for (size_t d = 0; d < config.embedding_dim; ++d) {
-                                target_emb[0][d] = (*word_embeddings)[target_idx][d];
-                                context_emb[0][d] = (*context_embeddings)[context_idx][d];
-                            }
+    // Scratch of the shared-negative mode, sized once per thread. The
+    // window's context words are the input rows, the centre word and the
+    // negatives the output rows.
+    struct window_batch {
+        std::vector<size_t> inputs, outputs;
+        std::vector<T> in_rows, out_rows, out_cols, scores, in_grad, out_grad;
+
+        window_batch(size_t window, size_t negatives, size_t dim)
+            : inputs(2 * window), outputs(1 + negatives),
+              in_rows(2 * window * dim), out_rows((1 + negatives) * dim), out_cols((1 + negatives) * dim),
+              scores(2 * window * (1 + negatives)), in_grad(2 * window * dim), out_grad((1 + negatives) * dim) {}
+    };
 
-                            T dot_product = 0.0f;
-                            for (size_t d = 0; d < config.embedding_dim; ++d) {
-                                dot_product += target_emb[0][d] * context_emb[0][d];
-                            }
+    // All pairs of a window against one set of negatives:
+    //   S = In * Out^T        (count x D) * (D x (1 + K))
+    //   G = alpha * (label - sigmoid(S)), label 1 in column 0
+    //   dIn = G * Out, dOut = G^T * In
+    // Returns the loss of the window and adds the samples scored to scored.
+    T train_window(size_t count, T alpha, fast_rng& gen, window_batch& batch, size_t& scored) {
+        using kernel = skip_gram_kernel<T>;
+        const size_t dim = config.embedding_dim;
+        const size_t outs = batch.outputs.size();
+        T* const words = word_embeddings->data();
+        T* const contexts = context_embeddings->data();
+
+        negative_table.sample(gen, batch.outputs.data() + 1, outs - 1);
+        for (size_t i = 0; i < count; ++i)
+            std::copy(words + batch.inputs[i] * dim, words + (batch.inputs[i] + 1) * dim, batch.in_rows.begin() + i * dim);
+        // Out row-major for dIn, and D x (1 + K) for S so that B has unit
+        // column stride there too
+        for (size_t j = 0; j < outs; ++j) {
+            const T* row = contexts + batch.outputs[j] * dim;
+            std::copy(row, row + dim, batch.out_rows.begin() + j * dim);
+            for (size_t d = 0; d < dim; ++d)
+                batch.out_cols[d * outs + j] = row[d];
+        }
 
-                            T sigmoid_val = 1.0f / (1.0f + std::exp(-dot_product));
-                            T grad = config.learning_rate * (1.0f - sigmoid_val);
+        T* const scores = batch.scores.data();
+        gemm_kernel<T>::run(count, outs, dim, batch.in_rows.data(), dim, 1, batch.out_cols.data(), outs, 1,
+                            scores, outs, 1, 0, false);
+        T loss = 0;
+        for (size_t i = 0; i < count; ++i) {
+            for (size_t j = 0; j < outs; ++j) {
+                T& g = scores[i * outs + j];
+                // a negative drawn equal to the centre word is skipped
+                if (j && batch.outputs[j] == batch.outputs[0]) {
+                    g = 0;
+                    continue;
+                }
+                loss -= kernel::log_sigmoid(j ? -g : g);
+                g = alpha * ((j ? 0 : 1) - kernel::sigmoid(g));
+                ++scored;
+            }
+        }
+        gemm_kernel<T>::run(count, dim, outs, scores, outs, 1, batch.out_rows.data(), dim, 1,
+                            batch.in_grad.data(), dim, 1, 0, false);
+        gemm_kernel<T>::run(outs, dim, count, scores, 1, outs, batch.in_rows.data(), dim, 1,
+                            batch.out_grad.data(), dim, 1, 0, false);
+
+        for (size_t i = 0; i < count; ++i)
+            kernel::axpy(1, batch.in_grad.data() + i * dim, words + batch.inputs[i] * dim, dim);
+        for (size_t j = 0; j < outs; ++j)
+            kernel::axpy(1, batch.out_grad.data() + j * dim, contexts + batch.outputs[j] * dim, dim);
+        return loss;
+    }
 
-                            // Update embeddings
-                            for (size_t d = 0; d < config.embedding_dim; ++d) {
-                                (*word_embeddings)[target_idx][d] += grad * context_emb[0][d];
-                                (*context_embeddings)[context_idx][d] += grad * target_emb[0][d];
-                            }
+    // Skip-gram pairs of the tokens [begin, end) of the concatenated
+    // sentences, windows never cross a sentence. alpha is refreshed from
+    // the shared progress every PROGRESS_STEP tokens.
+    void train_range(size_t begin, size_t end,
+                     fast_rng& gen, train_progress& progress, T& range_loss, size_t& range_pairs) {
+        using kernel = skip_gram_kernel<T>;
+        const size_t dim = config.embedding_dim;
+        T* const words = word_embeddings->data();
+        T* const contexts = context_embeddings->data();
+        // gradient of the target row, applied once all samples of a pair
+        // have read the unchanged row
+        std::vector<T> target_grad(dim);
+        std::vector<size_t> negatives(config.negative_samples);
+        window_batch batch(config.window_size, config.negative_samples, dim);
+        kernel::tables();
+
+        T alpha = learning_rate_at(progress.words.load(std::memory_order_relaxed), progress.total);
+        size_t pending = 0;
+        T loss = 0;
+        size_t pairs = 0;
+
+        const std::vector<size_t>& offset = sentence_offset;
+        size_t s = std::upper_bound(offset.begin(), offset.end(), begin) - offset.begin() - 1;
+        for (size_t token = begin; token < end; ++token) {
+            while (token >= offset[s + 1])
+                ++s;
+            const uint32_t* const sentence = stream.data() + offset[s];
+            const size_t sentence_size = offset[s + 1] - offset[s];
+            const size_t pos = token - offset[s];
+            const size_t target_idx = sentence[pos];
+
+            if (++pending == PROGRESS_STEP) {
+                const size_t done = progress.words.fetch_add(pending, std::memory_order_relaxed) + pending;
+                alpha = learning_rate_at(done, progress.total);
+                pending = 0;
+            }
+            if (!config.use_negative_sampling) {
+                continue;
+            }
 
-                            total_loss -= std::log(sigmoid_val + 1e-10f);
+            // Generate context window
+            size_t window_start = (pos > config.window_size) ? (pos - config.window_size) : 0;
+            size_t window_end = std::min(pos + config.window_size + 1, sentence_size);
+            T* const target = words + target_idx * dim;
 
-                            // Negative samples
-                            for (size_t neg_idx : neg_samples) {
-                                for (size_t d = 0; d < config.embedding_dim; ++d) {
-                                    context_emb[0][d] = (*context_embeddings)[neg_idx][d];
-                                }
+            if (config.shared_negatives) {
+                size_t count = 0;
+                for (size_t ctx_pos = window_start; ctx_pos < window_end; ++ctx_pos) {
+                    if (ctx_pos != pos) {
+                        batch.inputs[count++] = sentence[ctx_pos];
+                    }
+                }
+                batch.outputs[0] = target_idx;
+                if (count) {
+                    loss += train_window(count, alpha, gen, batch, pairs);
+                }
+                continue;
+            }
 
-                                dot_product = 0.0f;
-                                for (size_t d = 0; d < config.embedding_dim; ++d) {
-                                    dot_product += target_emb[0][d] * context_emb[0][d];
-                                }
+            for (size_t ctx_pos = window_start; ctx_pos < window_end; ++ctx_pos) {
+                if (ctx_pos == pos) continue;
+
+                std::fill(target_grad.begin(), target_grad.end(), T(0));
+                negative_table.sample(gen, negatives.data(), negatives.size());
+                // sample 0 is the context word (label 1), the rest negatives
+                for (size_t d = 0; d <= config.negative_samples; ++d) {
+                    const size_t idx = d ? negatives[d - 1] : sentence[ctx_pos];
+                    if (d && idx == sentence[ctx_pos]) continue;
+                    T* const sample = contexts + idx * dim;
+                    const T score = kernel::dot(target, sample, dim);
+                    const T grad = alpha * ((d ? 0 : 1) - kernel::sigmoid(score));
+                    kernel::axpy(grad, sample, target_grad.data(), dim);
+                    kernel::axpy(grad, target, sample, dim);
+                    loss -= kernel::log_sigmoid(d ? -score : score);
+                    ++pairs;
+                }
+                kernel::axpy(1, target_grad.data(), target, dim);
+            }
+        }
+        progress.words.fetch_add(pending, std::memory_order_relaxed);
+        range_loss = loss;
+        range_pairs = pairs;
+    }
 
-                                sigmoid_val = 1.0f / (1.0f + std::exp(-dot_product));
-                                grad = config.learning_rate * (0.0f - sigmoid_val);
+public:
+    // Hogwild training: the tokens are split into one contiguous range per
+    // requested thread, every range has its own RNG and loss, and all of
+    // them update the shared embeddings without locks. The ranges are handed
+    // out by an omp for, so a smaller team than asked for (OMP_DYNAMIC, a
+    // thread limit, a call from inside a parallel region) still trains all
+    // of them. The learning rate decays linearly with the number of tokens
+    // trained so far by all threads.
+    void train() {
+        MATRIX_PROFILE_SCOPE("w2v_train", 0, 0);
+        if (!word_embeddings || !context_embeddings) {
+            initialize_embeddings();
+        }
+        if (negative_table.size() != vocab_size) {
+            build_negative_table();
+        }
 
-                                for (size_t d = 0; d < config.embedding_dim; ++d) {
-                                    (*word_embeddings)[target_idx][d] += grad * context_emb[0][d];
-                                    (*context_embeddings)[neg_idx][d] += grad * target_emb[0][d];
-                                }
+        if (sentence_offset.empty()) {
+            sentence_offset.assign(1, 0);
+        }
+        const size_t total = stream.size();
+        const size_t threads = std::max<size_t>(1, std::min<size_t>(
+            config.threads ? config.threads : static_cast<size_t>(omp_get_max_threads()), total));
 
-                                total_loss -= std::log(1.0f - sigmoid_val + 1e-10f);
-                            }
+        train_progress progress;
+        progress.total = config.epochs * total;
+        epoch_losses.clear();
 
-                            total_pairs += (1 + config.negative_samples);
-                        }
-                    }
-                }
+        for (size_t epoch = 0; epoch < config.epochs; ++epoch) {
+            MATRIX_PROFILE_SCOPE("w2v_epoch", 0, 0);
+            std::vector<std::uint64_t> seeds(threads);
+            for (auto& seed : seeds)
+                seed = (static_cast<std::uint64_t>(rng()) << 32) | rng();
+            std::vector<T> losses(threads, 0);
+            std::vector<size_t> pairs(threads, 0);
+
+            #pragma omp parallel for schedule(static, 1) num_threads(static_cast<int>(threads)) if(threads > 1)
+            for (size_t t = 0; t < threads; ++t) {
+                fast_rng gen(seeds[t]);
+                train_range(total * t / threads, total * (t + 1) / threads,
+                            gen, progress, losses[t], pairs[t]);
             }
 
+            T total_loss = 0.0f;
+            size_t total_pairs = 0;
+            for (size_t t = 0; t < threads; ++t) {
+                total_loss += losses[t];
+                total_pairs += pairs[t];
+            }
             T avg_loss = (total_pairs > 0) ? total_loss / total_pairs : 0.0f;
+            epoch_losses.push_back(avg_loss);
             std::cout << "Epoch " << (epoch + 1) << "/" << config.epochs
                       << " - Loss: " << avg_loss << std::endl;
         }
     }
 
+    // Average loss per sample of every epoch of the last train()
+    const std::vector<T>& get_epoch_losses() const { return epoch_losses; }
+    const alias_table& get_negative_sampler() const { return negative_table; }
+
     std::vector<T> get_word_vector(const std::string& word) const {
         auto it = word2idx.find(word);
         if (it == word2idx.end()) {
             throw std::runtime_error("Word not in vocabulary: " + word);
         }
 
-        size_t idx = it->second;
-        std::vector<T> vec(config.embedding_dim);
-        for (size_t j = 0; j < config.embedding_dim; ++j) {
-            vec[j] = (*word_embeddings)[idx][j];
-        }
-        return vec;
+        const auto row = static_cast<const matrix<T>&>(*word_embeddings).row_view(it->second);
+        return std::vector<T>(row.data(), row.data() + config.embedding_dim);
     }
 
     std::vector<std::pair<std::string, T>> most_similar(const std::string& word, size_t top_n = 10) const {
+        MATRIX_PROFILE_SCOPE("w2v_most_similar", 2.0 * vocab_size * config.embedding_dim, sizeof(T) * vocab_size * config.embedding_dim);
         auto target_vec = get_word_vector(word);
 
         // Normalize target vector
@@ -293,19 +497,15 @@ public:
             }
         }
 
+        const matrix_view<const T> target(target_vec.data(), 1, config.embedding_dim, config.embedding_dim);
         std::vector<std::pair<std::string, T>> similarities;
 
         for (size_t idx = 0; idx < vocab_size; ++idx) {
             if (idx2word[idx] == word) continue;
 
-            T dot = 0.0f;
-            T vec_norm = 0.0f;
-
-            for (size_t d = 0; d < config.embedding_dim; ++d) {
-                dot += target_vec[d] * (*word_embeddings)[idx][d];
-                vec_norm += (*word_embeddings)[idx][d] * (*word_embeddings)[idx][d];
-            }
-            vec_norm = std::sqrt(vec_norm);
+            const auto row = static_cast<const matrix<T>&>(*word_embeddings).row_view(idx);
+            T dot = target.hadamard(row).sum();
+            T vec_norm = std::sqrt(row.pow(2).sum());
 
             T cosine_sim = (vec_norm > 0) ? dot / vec_norm : 0.0f;
             similarities.emplace_back(idx2word[idx], cosine_sim);
@@ -326,6 +526,7 @@ public:
     size_t get_embedding_dim() const { return config.embedding_dim; }
 
     void save_embeddings(const std::string& filepath) const {
+        MATRIX_PROFILE_SCOPE("w2v_save", 0, 2 * sizeof(T) * vocab_size * config.embedding_dim);
         // Save vocabulary to text file
         std::string vocab_path = filepath + ".vocab";
         std::ofstream vocab_out(vocab_path);
@@ -354,6 +555,7 @@ public:
     }
 
     void load_embeddings(const std::string& filepath) {
+        MATRIX_PROFILE_SCOPE("w2v_load", 0, 0);
         // Load vocabulary and word embeddings from text file
         std::string vocab_path = filepath + ".vocab";
         std::ifstream vocab_in(vocab_path);
@@ -363,6 +565,7 @@ public:
 
         idx2word.clear();
         word2idx.clear();
+        idx_counts.clear();
 
         size_t saved_vocab_size, saved_dim;
         vocab_in >> saved_vocab_size >> saved_dim;
@@ -43,14 +43,17 @@ int main() {
     auto res = large * large.transpose();
     auto end = clk::now();
     auto t = static_cast<float>((end - begin).count()) / den;
+    const auto flops = 2.0 * large.get_row() * large.get_row() * large.get_col();
     std::cout << "time (omp parallel): " << t << " s "
-              << "(" << large.get_col() << " x " << large.get_row() << ")\n";
+              << "(" << large.get_col() << " x " << large.get_row() << ") "
+              << flops / t * 1e-9 << " GFLOPS\n";
 
     auto begin_seq = clk::now();
     auto res_seq = large.mult_sequential(large.transpose());
     auto end_seq = clk::now();
     auto t_seq = static_cast<float>((end_seq - begin_seq).count()) / den;
     std::cout << "time (no parallel): " << t_seq << " s "
-              << "(" << large.get_col() << " x " << large.get_row() << ")\n";
+              << "(" << large.get_col() << " x " << large.get_row() << ") "
+              << flops / t_seq * 1e-9 << " GFLOPS\n";
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,144 @@
+#include "alias_table.hpp"
+#include "word2vec.hpp"
+#include <iostream>
+#include <sstream>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+void check_distribution(const std::vector<double>& weight, double power) {
+    const alias_table table(weight, power);
+    assert(table.size() == weight.size());
+    assert(table.memory_bytes() == 8 * weight.size());
+
+    double total = 0;
+    for (double w : weight)
+        total += std::pow(w, power);
+    const size_t draws = 2000000;
+    std::vector<size_t> hits(weight.size(), 0);
+    fast_rng rng(11);
+    for (size_t i = 0; i < draws; ++i)
+        ++hits[table.sample(rng)];
+    for (size_t i = 0; i < weight.size(); ++i) {
+        const double expect = draws * std::pow(weight[i], power) / total;
+        // five standard deviations
+        assert(std::abs(hits[i] - expect) <= 5 * std::sqrt(expect) + 1);
+        if (weight[i] == 0) {
+            assert(hits[i] == 0);
+        }
+    }
+}
+
+void test_distribution() {
+    check_distribution({1, 2, 3, 4, 0, 10}, 1);
+    check_distribution({1, 2, 3, 4, 0, 10}, 0.75);
+    check_distribution({5}, 0.75);
+
+    // Zipf-like counts, as in a corpus
+    std::vector<double> zipf(1000);
+    for (size_t i = 0; i < zipf.size(); ++i)
+        zipf[i] = 100000.0 / (i + 1);
+    check_distribution(zipf, 0.75);
+
+    std::cout << "Distribution Test Passed!" << std::endl;
+}
+
+void test_rng_and_buffers() {
+    const alias_table table(std::vector<int>{3, 1, 4, 1, 5, 9, 2, 6}, 0.75);
+    fast_rng a(42), b(42), c(43);
+    size_t x[64], y[64], z[64];
+    table.sample(a, x, 64);
+    table.sample(b, y, 64);
+    table.sample(c, z, 64);
+    bool differ = false;
+    for (size_t i = 0; i < 64; ++i) {
+        assert(x[i] == y[i] && x[i] < 8);
+        differ |= x[i] != z[i];
+    }
+    assert(differ);
+
+    fast_rng r(7);
+    for (size_t i = 0; i < 10000; ++i)
+        assert(r.below(13) < 13);
+    std::cout << "RNG Test Passed!" << std::endl;
+}
+
+void test_errors() {
+    const std::vector<std::vector<double>> bad = {{}, {1, -1}, {0, 0}, {1, NAN}};
+    for (const auto& weight : bad) {
+        bool thrown = false;
+        try {
+            alias_table table(weight);
+        } catch (const std::runtime_error&) {
+            thrown = true;
+        }
+        assert(thrown);
+    }
+    std::cout << "Errors Test Passed!" << std::endl;
+}
+
+void test_word2vec_sampler() {
+    Word2Vec<float>::TrainingConfig config;
+    config.embedding_dim = 8;
+    Word2Vec<float> w2v(config);
+    w2v.load_corpus("a a a a a a a a b b c");
+    std::ostringstream quiet;
+    std::streambuf* saved = std::cout.rdbuf(quiet.rdbuf());
+    w2v.prepare_training_data();
+    std::cout.rdbuf(saved);
+    assert(quiet.str().find("Negative sampler: 3 words") != std::string::npos);
+
+    const alias_table& table = w2v.get_negative_sampler();
+    assert(table.size() == w2v.get_vocab_size());
+    std::vector<size_t> hits(3, 0);
+    fast_rng rng(5);
+    for (size_t i = 0; i < 300000; ++i)
+        ++hits[table.sample(rng)];
+    // 8^0.75 : 2^0.75 : 1
+    assert(std::abs(hits[0] / static_cast<double>(hits[2]) - std::pow(8, 0.75)) < 0.1);
+    assert(std::abs(hits[1] / static_cast<double>(hits[2]) - std::pow(2, 0.75)) < 0.05);
+    std::cout << "Word2Vec Sampler Test Passed!" << std::endl;
+}
+
+void test_speed() {
+    std::vector<double> zipf(100000);
+    for (size_t i = 0; i < zipf.size(); ++i)
+        zipf[i] = 1e7 / (i + 1);
+    const alias_table table(zipf, 0.75);
+    const size_t draws = 20000000;
+    size_t sink = 0;
+
+    std::mt19937 gen(1);
+    std::uniform_int_distribution<size_t> uniform(0, zipf.size() - 1);
+    auto begin = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < draws; ++i)
+        sink += uniform(gen);
+    const double old_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+    fast_rng rng(1);
+    size_t buffer[256];
+    begin = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < draws; i += 256) {
+        table.sample(rng, buffer, 256);
+        sink += buffer[255];
+    }
+    const double alias_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+    std::cout << "mt19937 uniform: " << draws / old_time * 1e-6 << " M draws/s, alias table: "
+              << draws / alias_time * 1e-6 << " M draws/s (" << zipf.size() << " words, "
+              << table.memory_bytes() / 1024 << " KiB, built in " << table.build_seconds() * 1e3 << " ms)"
+              << (sink == 1 ? " " : "") << std::endl;
+}
+
+int main() {
+    test_distribution();
+    test_rng_and_buffers();
+    test_errors();
+    test_word2vec_sampler();
+    test_speed();
+    std::cout << "All tests passed!" << std::endl;
+    return 0;
+}
@@ -0,0 +1,213 @@
+#include "corpus.hpp"
+#include "word2vec.hpp"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <cassert>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// The tokenizer Word2Vec used to have: >> words, keep lowercased letters.
+std::vector<std::string> reference_tokens(const std::string& text) {
+    std::vector<std::string> words;
+    std::istringstream iss(text);
+    std::string word;
+    while (iss >> word) {
+        std::string cleaned;
+        for (char c : word) {
+            if (std::isalpha(static_cast<unsigned char>(c))) {
+                cleaned += static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+            }
+        }
+        if (!cleaned.empty()) {
+            words.push_back(cleaned);
+        }
+    }
+    return words;
+}
+
+std::string random_text(size_t words, uint32_t seed) {
+    const char* pieces[] = {"The", "quick", "brown", "FOX", "don't", "42", "e-mail", "x", "naïve", "ok!",
+                            "--", "Jumps", "over", "lazy", "dog.", "a1b2"};
+    const char* spaces[] = {" ", "  ", "\n", "\r\n", "\t", " \v ", "\f"};
+    std::mt19937 gen(seed);
+    std::string text;
+    for (size_t i = 0; i < words; ++i) {
+        text += pieces[gen() % 16];
+        if (gen() % 5 == 0) {
+            text += pieces[gen() % 16];
+        }
+        text += spaces[gen() % 7];
+    }
+    return text;
+}
+
+void check_same(const std::string& text, const token_dictionary& dict, const std::vector<uint32_t>& tokens) {
+    const std::vector<std::string> expect = reference_tokens(text);
+    assert(tokens.size() == expect.size());
+    std::vector<size_t> counts(dict.size(), 0);
+    uint32_t next = 0;
+    for (size_t i = 0; i < tokens.size(); ++i) {
+        assert(dict.word(tokens[i]) == expect[i]);
+        // ids in order of first appearance
+        assert(tokens[i] <= next);
+        next += tokens[i] == next;
+        ++counts[tokens[i]];
+    }
+    for (uint32_t id = 0; id < dict.size(); ++id) {
+        assert(dict.count(id) == counts[id]);
+        assert(dict.find(dict.word(id)) == id);
+    }
+    assert(dict.find("missing") == token_dictionary::NONE);
+}
+
+void test_tokenize() {
+    for (uint32_t seed = 1; seed <= 5; ++seed) {
+        const std::string text = random_text(5000, seed);
+        token_dictionary dict;
+        std::vector<uint32_t> tokens;
+        const size_t words = corpus_tokenizer::append(text.data(), text.data() + text.size(), dict, tokens);
+        assert(words == tokens.size());
+        check_same(text, dict, tokens);
+    }
+
+    token_dictionary dict;
+    std::vector<uint32_t> tokens;
+    const std::string blank = " \n\t 123 -- ";
+    assert(corpus_tokenizer::append(blank.data(), blank.data() + blank.size(), dict, tokens) == 0);
+    assert(dict.size() == 0);
+    std::cout << "Tokenize Test Passed!" << std::endl;
+}
+
+// Forces many pieces per block even on one core.
+void test_threaded() {
+    const auto saved = parallel_dispatch::threshold(parallel_op::transcendental);
+    const int threads = omp_get_max_threads();
+    parallel_dispatch::set_threshold(parallel_op::transcendental, 0);
+    omp_set_num_threads(4);
+
+    for (uint32_t seed = 10; seed < 13; ++seed) {
+        const std::string text = random_text(20000, seed);
+        token_dictionary dict;
+        std::vector<uint32_t> tokens;
+        corpus_tokenizer::append(text.data(), text.data() + text.size(), dict, tokens);
+        check_same(text, dict, tokens);
+    }
+    const std::string tiny = "a";
+    token_dictionary dict;
+    std::vector<uint32_t> tokens;
+    corpus_tokenizer::append(tiny.data(), tiny.data() + 1, dict, tokens);
+    assert(tokens.size() == 1 && dict.word(0) == "a");
+
+    omp_set_num_threads(threads);
+    parallel_dispatch::set_threshold(parallel_op::transcendental, saved);
+    std::cout << "Threaded Test Passed!" << std::endl;
+}
+
+void test_file() {
+    const std::string text = random_text(30000, 21);
+    {
+        std::ofstream out("test_corpus.tmp", std::ios::binary);
+        out << text;
+    }
+    // chunks that cut words, single bytes, and the whole file at once
+    for (size_t chunk : {size_t(1), size_t(7), size_t(4096), corpus_tokenizer::CHUNK}) {
+        token_dictionary dict;
+        std::vector<uint32_t> tokens;
+        corpus_tokenizer::append_file("test_corpus.tmp", dict, tokens, chunk);
+        check_same(text, dict, tokens);
+    }
+
+    { std::ofstream empty("test_corpus.tmp", std::ios::binary); }
+    token_dictionary dict;
+    std::vector<uint32_t> tokens;
+    assert(corpus_tokenizer::append_file("test_corpus.tmp", dict, tokens) == 0);
+
+    bool thrown = false;
+    try {
+        corpus_tokenizer::append_file("test_corpus_missing.tmp", dict, tokens);
+    } catch (const std::runtime_error&) {
+        thrown = true;
+    }
+    assert(thrown);
+    std::cout << "File Test Passed!" << std::endl;
+}
+
+void test_word2vec() {
+    const std::string text = random_text(20000, 31);
+    {
+        std::ofstream out("test_corpus.tmp", std::ios::binary);
+        out << text;
+    }
+    Word2Vec<float>::TrainingConfig config;
+    config.embedding_dim = 8;
+    config.epochs = 1;
+    config.min_count = 2;
+    Word2Vec<float> from_text(config), from_file(config);
+    from_text.load_corpus(text);
+    from_file.load_corpus_from_file("test_corpus.tmp");
+    assert(from_text.get_corpus_size() == reference_tokens(text).size());
+    assert(from_file.get_corpus_size() == from_text.get_corpus_size());
+
+    std::ostringstream quiet;
+    std::streambuf* saved = std::cout.rdbuf(quiet.rdbuf());
+    from_text.prepare_training_data();
+    from_file.prepare_training_data();
+    from_file.train();
+    std::cout.rdbuf(saved);
+    assert(from_text.get_vocab_size() == from_file.get_vocab_size());
+    // "x" appears many times, "a1b2" cleans to "ab"
+    assert(from_file.get_word_vector("x").size() == 8);
+    assert(from_file.get_word_vector("ab").size() == 8);
+
+    // a new corpus replaces the old one
+    from_text.load_corpus("one two two");
+    assert(from_text.get_corpus_size() == 3);
+    std::cout << "Word2Vec Test Passed!" << std::endl;
+}
+
+void test_speed() {
+    const std::string text = random_text(4000000, 41);
+    {
+        std::ofstream out("test_corpus.tmp", std::ios::binary);
+        out << text;
+    }
+
+    // what load_corpus_from_file used to do
+    auto begin = std::chrono::steady_clock::now();
+    std::ifstream in("test_corpus.tmp");
+    std::stringstream buffer;
+    buffer << in.rdbuf();
+    const std::vector<std::string> old_tokens = reference_tokens(buffer.str());
+    const double old_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    size_t old_bytes = old_tokens.capacity() * sizeof(std::string);
+    for (const auto& word : old_tokens)
+        old_bytes += word.capacity() > 15 ? word.capacity() + 1 : 0;
+
+    begin = std::chrono::steady_clock::now();
+    token_dictionary dict;
+    std::vector<uint32_t> tokens;
+    corpus_tokenizer::append_file("test_corpus.tmp", dict, tokens);
+    const double new_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    assert(tokens.size() == old_tokens.size());
+
+    std::cout << "stringstream + vector<string>: " << old_time << " s, " << old_bytes / 1048576.0
+              << " MiB of tokens; mapped tokenizer: " << new_time << " s, "
+              << tokens.capacity() * sizeof(uint32_t) / 1048576.0 << " MiB of ids ("
+              << text.size() / 1048576.0 << " MiB of text)" << std::endl;
+}
+
+int main() {
+    test_tokenize();
+    test_threaded();
+    test_file();
+    test_word2vec();
+    test_speed();
+    std::remove("test_corpus.tmp");
+    std::cout << "All tests passed!" << std::endl;
+    return 0;
+}
@@ -0,0 +1,359 @@
+#include "matrix.hpp"
+#include <iostream>
+#include <cassert>
+#include <cmath>
+
+template<typename T>
+bool close(T a, T b, T tolerance = 1e-6) {
+    return std::abs(a - b) < tolerance;
+}
+
+void test_fused_chain() {
+    matrix<float> a(33, 17), b(33, 17), c(33, 17);
+    a.random_init();
+    b.random_init();
+    c.random_init();
+
+    matrix<float> r = ((a + b).hadamard(c) * 2.0f - 1.0f).tanh();
+    for (size_t i = 0; i < a.get_row(); ++i) {
+        for (size_t j = 0; j < a.get_col(); ++j) {
+            const float expect = std::tanh((a[i][j] + b[i][j]) * c[i][j] * 2.0f - 1.0f);
+            assert(close(r[i][j], expect));
+        }
+    }
+
+    // lazy sum never materializes the chain
+    float expect_sum = 0;
+    for (size_t i = 0; i < a.get_row(); ++i)
+        for (size_t j = 0; j < a.get_col(); ++j)
+            expect_sum += (a[i][j] - b[i][j]) * (a[i][j] - b[i][j]);
+    assert(close((a - b).pow(2).sum(), expect_sum, 1e-3f));
+
+    std::cout << "Fused Chain Test Passed!" << std::endl;
+}
+
+void test_temporaries_and_aliasing() {
+    matrix<double> a(8, 8), b(8, 8);
+    a.random_init();
+    b.random_init();
+
+    // operator* result is owned by the expression
+    auto lazy = (a * b + a).sigmoid();
+    matrix<double> product = a * b;
+    matrix<double> r = lazy;
+    for (size_t i = 0; i < 8; ++i)
+        for (size_t j = 0; j < 8; ++j)
+            assert(close(r[i][j], 1 / (1 + std::exp(-(product[i][j] + a[i][j])))));
+
+    // destination appears inside its own expression
+    matrix<double> c = a;
+    c = (c + b).relu();
+    c += c * 0.5;
+    for (size_t i = 0; i < 8; ++i)
+        for (size_t j = 0; j < 8; ++j)
+            assert(close(c[i][j], std::max(a[i][j] + b[i][j], 0.0) * 1.5));
+
+    // shape mismatch still throws
+    bool thrown = false;
+    try {
+        matrix<double> d = a + matrix<double>(8, 7);
+    } catch (const std::runtime_error&) {
+        thrown = true;
+    }
+    assert(thrown);
+
+    std::cout << "Temporaries And Aliasing Test Passed!" << std::endl;
+}
+
+void test_dispatch_thresholds() {
+    matrix<float> a(64, 64), b(64, 64);
+    a.random_init();
+    b.random_init();
+
+    const auto saved = parallel_dispatch::threshold(parallel_op::transcendental);
+    parallel_dispatch::set_threshold(parallel_op::transcendental, 0);
+    matrix<float> parallel_result = (a + b).sigmoid();
+    parallel_dispatch::set_threshold(parallel_op::transcendental, static_cast<size_t>(-1));
+    matrix<float> serial_result = (a + b).sigmoid();
+    parallel_dispatch::set_threshold(parallel_op::transcendental, saved);
+
+    for (size_t i = 0; i < a.get_row(); ++i)
+        for (size_t j = 0; j < a.get_col(); ++j)
+            assert(parallel_result[i][j] == serial_result[i][j]);
+
+    std::cout << "Dispatch Threshold Test Passed!" << std::endl;
+}
+
+void test_pool_reuse() {
+    matrix<float> a(37, 41), b(37, 41);
+    a.random_init();
+    b.random_init();
+    assert(reinterpret_cast<uintptr_t>(a.data()) % matrix_pool::ALIGNMENT == 0);
+
+    {
+        matrix<float> warm = a * b.transpose();
+    }
+    matrix_pool::reset_stats();
+    for (int i = 0; i < 10; ++i) {
+        matrix<float> temp = a * b.transpose();
+        assert(reinterpret_cast<uintptr_t>(temp.data()) % matrix_pool::ALIGNMENT == 0);
+    }
+    const auto stats = matrix_pool::stats();
+    assert(stats.misses == 0);
+    assert(stats.hits == 20);
+
+    std::cout << "Pool Reuse Test Passed!" << std::endl;
+}
+
+void test_views() {
+    matrix<float> a(6, 5);
+    for (size_t i = 0; i < 6; ++i)
+        for (size_t j = 0; j < 5; ++j)
+            a[i][j] = i * 10 + j;
+
+    // slicing aliases the storage
+    auto r = a.row_view(2);
+    auto c = a.col_view(3);
+    auto blk = a.block(1, 1, 3, 2);
+    assert(r.get_row() == 1 && r.get_col() == 5 && r.data() == a[2]);
+    assert(c.get_row() == 6 && c.get_col() == 1 && c(4, 0) == 43);
+    assert(blk(2, 1) == 32);
+    assert(close(c.sum(), 10.0f * 15 + 3 * 6));
+
+    blk *= 2.0f;
+    assert(a[1][1] == 22 && a[3][2] == 64 && a[4][2] == 42);
+
+    // assignment through a transposed view
+    matrix<float> t(5, 6);
+    t.view().transpose() = a;
+    for (size_t i = 0; i < 6; ++i)
+        for (size_t j = 0; j < 5; ++j)
+            assert(t[j][i] == a[i][j]);
+
+    // expressions over views, writing into a strided column
+    matrix<float> col(6, 1);
+    col = a.col_view(0) + a.col_view(4) * 2.0f;
+    a.col_view(1) = col;
+    for (size_t i = 0; i < 6; ++i)
+        assert(a[i][1] == a[i][0] + a[i][4] * 2.0f);
+
+    // gemm between blocks and into a transposed destination
+    matrix<float> x(8, 8), y(8, 8);
+    x.random_init();
+    y.random_init();
+    matrix<float> expect = matrix<float>(x.block(0, 0, 4, 3)) * matrix<float>(y.block(2, 2, 3, 5));
+    matrix<float> p = x.block(0, 0, 4, 3) * y.block(2, 2, 3, 5);
+    matrix<float> q(5, 4);
+    gemm<float>(q.view().transpose(), x.block(0, 0, 4, 3), y.block(2, 2, 3, 5));
+    for (size_t i = 0; i < 4; ++i) {
+        for (size_t j = 0; j < 5; ++j) {
+            assert(close(p[i][j], expect[i][j], 1e-4f));
+            assert(close(q[j][i], expect[i][j], 1e-4f));
+        }
+    }
+
+    // overlapping destination falls back to a temporary
+    matrix<float> z = x;
+    gemm<float>(z.block(0, 0, 4, 4), x.block(0, 0, 4, 4), z.block(0, 0, 4, 4));
+    matrix<float> zexpect = matrix<float>(x.block(0, 0, 4, 4)) * matrix<float>(x.block(0, 0, 4, 4));
+    for (size_t i = 0; i < 4; ++i)
+        for (size_t j = 0; j < 4; ++j)
+            assert(close(z[i][j], zexpect[i][j], 1e-4f));
+
+    bool thrown = false;
+    try {
+        a.row_view(6);
+    } catch (const std::runtime_error&) {
+        thrown = true;
+    }
+    assert(thrown);
+
+    std::cout << "Views Test Passed!" << std::endl;
+}
+
+void test_broadcast() {
+    matrix<float> x(37, 5), w(5, 19), bias(1, 19), scale(37, 1);
+    x.random_init();
+    w.random_init();
+    bias.random_init();
+    scale.random_init();
+    const matrix<float> xw = x * w;
+
+    // the rvalue product is owned by the expression, bias is read in place
+    matrix<float> h = (x * w).add_row(bias).tanh();
+    matrix<float> d = xw.sub_row(bias).mul_col(scale);
+    matrix<float> s = xw.add_col(scale).mul_row(bias.view());
+    for (size_t i = 0; i < xw.get_row(); ++i) {
+        for (size_t j = 0; j < xw.get_col(); ++j) {
+            assert(close(h[i][j], std::tanh(xw[i][j] + bias[0][j])));
+            assert(close(d[i][j], (xw[i][j] - bias[0][j]) * scale[i][0]));
+            assert(close(s[i][j], (xw[i][j] + scale[i][0]) * bias[0][j]));
+        }
+    }
+
+    // column views broadcast across a block
+    matrix<float> c = xw;
+    c.block(1, 2, 4, 3) -= broadcast_col(xw.col_view(0).block(0, 0, 4, 1), 3);
+    for (size_t i = 0; i < 4; ++i)
+        for (size_t j = 0; j < 3; ++j)
+            assert(close(c[i + 1][j + 2], xw[i + 1][j + 2] - xw[i][0]));
+
+    // the destination's own row or column under a broadcast
+    matrix<float> y(3, 2);
+    for (size_t i = 0; i < 6; ++i)
+        y.data()[i] = static_cast<float>(i + 1);
+    y = y.sub_row(y.row_view(0));
+    const float centered[] = {0, 0, 2, 2, 4, 4};
+    for (size_t i = 0; i < 6; ++i)
+        assert(y.data()[i] == centered[i]);
+    matrix<float> z = xw;
+    z -= broadcast_col(z.col_view(3), z.get_col());
+    z.view() += broadcast_row(z.row_view(5), z.get_row());
+    for (size_t i = 0; i < xw.get_row(); ++i)
+        for (size_t j = 0; j < xw.get_col(); ++j)
+            assert(close(z[i][j], xw[i][j] - xw[i][3] + xw[5][j] - xw[5][3]));
+
+    // a transposed view of the destination
+    matrix<float> sq(4, 4), sq_t(4, 4);
+    sq.random_init();
+    for (size_t i = 0; i < 4; ++i)
+        for (size_t j = 0; j < 4; ++j)
+            sq_t[i][j] = sq[j][i];
+    sq.view() = sq.view().transpose();
+    for (size_t i = 0; i < 4; ++i)
+        for (size_t j = 0; j < 4; ++j)
+            assert(sq[i][j] == sq_t[i][j]);
+
+    bool thrown = false;
+    try {
+        auto bad = xw.add_row(scale);
+        (void)bad;
+    } catch (const std::runtime_error&) {
+        thrown = true;
+    }
+    assert(thrown);
+    thrown = false;
+    try {
+        auto bad = xw.add_col(bias);
+        (void)bad;
+    } catch (const std::runtime_error&) {
+        thrown = true;
+    }
+    assert(thrown);
+
+    std::cout << "Broadcast Test Passed!" << std::endl;
+}
+
+void check_axis_reductions(const matrix<double>& a) {
+    const size_t rows = a.get_row(), cols = a.get_col();
+    const matrix<double> col_sum = a.sum(reduce_axis::rows);
+    const matrix<double> col_max = a.max(reduce_axis::rows);
+    const matrix<double> col_min = a.min(reduce_axis::rows);
+    const matrix<double> col_mean = a.mean(reduce_axis::rows);
+    const auto col_arg = a.argmax(reduce_axis::rows);
+    assert(col_sum.get_row() == 1 && col_sum.get_col() == cols);
+    assert(col_arg.size() == cols);
+    for (size_t j = 0; j < cols; ++j) {
+        double sum = 0, mx = a[0][j], mn = a[0][j];
+        size_t arg = 0;
+        for (size_t i = 0; i < rows; ++i) {
+            sum += a[i][j];
+            mn = std::min(mn, a[i][j]);
+            if (a[i][j] > mx) {
+                mx = a[i][j];
+                arg = i;
+            }
+        }
+        assert(close(col_sum[0][j], sum, 1e-9));
+        assert(close(col_mean[0][j], sum / rows, 1e-9));
+        assert(col_max[0][j] == mx && col_min[0][j] == mn && col_arg[j] == arg);
+    }
+
+    const matrix<double> row_sum = a.sum(reduce_axis::cols);
+    const matrix<double> row_max = a.max(reduce_axis::cols);
+    const matrix<double> row_min = a.min(reduce_axis::cols);
+    const matrix<double> row_mean = a.mean(reduce_axis::cols);
+    const auto row_arg = a.argmax(reduce_axis::cols);
+    assert(row_sum.get_row() == rows && row_sum.get_col() == 1);
+    assert(row_arg.size() == rows);
+    for (size_t i = 0; i < rows; ++i) {
+        double sum = 0, mx = a[i][0], mn = a[i][0];
+        size_t arg = 0;
+        for (size_t j = 0; j < cols; ++j) {
+            sum += a[i][j];
+            mn = std::min(mn, a[i][j]);
+            if (a[i][j] > mx) {
+                mx = a[i][j];
+                arg = j;
+            }
+        }
+        assert(close(row_sum[i][0], sum, 1e-9));
+        assert(close(row_mean[i][0], sum / cols, 1e-9));
+        assert(row_max[i][0] == mx && row_min[i][0] == mn && row_arg[i] == arg);
+    }
+}
+
+void test_axis_reductions() {
+    const size_t shapes[][2] = {{1, 1}, {1, 40}, {40, 1}, {37, 53}, {300, 17}};
+    for (const auto& shape : shapes) {
+        matrix<double> a(shape[0], shape[1]);
+        a.random_init();
+        check_axis_reductions(a);
+    }
+
+    // ties keep the first index
+    matrix<double> t(3, 4);
+    for (size_t i = 0; i < 3; ++i)
+        for (size_t j = 0; j < 4; ++j)
+            t[i][j] = 1;
+    assert(t.argmax(reduce_axis::rows) == std::vector<size_t>(4, 0));
+    assert(t.argmax(reduce_axis::cols) == std::vector<size_t>(3, 0));
+
+    // lazy operands and views are reduced without evaluating them first
+    matrix<double> a(64, 48), b(64, 48);
+    a.random_init();
+    b.random_init();
+    const matrix<double> ab = a.hadamard(b);
+    const matrix<double> lazy = a.hadamard(b).sum(reduce_axis::rows);
+    const matrix<double> eager = ab.sum(reduce_axis::rows);
+    for (size_t j = 0; j < ab.get_col(); ++j)
+        assert(close(lazy[0][j], eager[0][j], 1e-12));
+    const matrix<double> block_max = ab.block(3, 5, 10, 7).max(reduce_axis::cols);
+    for (size_t i = 0; i < 10; ++i) {
+        double mx = ab[i + 3][5];
+        for (size_t j = 5; j < 12; ++j)
+            mx = std::max(mx, ab[i + 3][j]);
+        assert(block_max[i][0] == mx);
+    }
+
+    // the threaded path gives the same results
+    const auto saved = parallel_dispatch::threshold(parallel_op::reduction);
+    const int threads = omp_get_max_threads();
+    parallel_dispatch::set_threshold(parallel_op::reduction, 0);
+    omp_set_num_threads(4);
+    check_axis_reductions(ab);
+    omp_set_num_threads(threads);
+    parallel_dispatch::set_threshold(parallel_op::reduction, saved);
+
+    bool thrown = false;
+    try {
+        matrix<double>(0, 0).sum(reduce_axis::rows);
+    } catch (const std::runtime_error&) {
+        thrown = true;
+    }
+    assert(thrown);
+
+    std::cout << "Axis Reduction Test Passed!" << std::endl;
+}
+
+int main() {
+    test_fused_chain();
+    test_temporaries_and_aliasing();
+    test_dispatch_thresholds();
+    test_pool_reuse();
+    test_views();
+    test_broadcast();
+    test_axis_reductions();
+    std::cout << "All tests passed!" << std::endl;
+    return 0;
+}
@@ -0,0 +1,223 @@
+#include "fixed_matrix.hpp"
+#include <iostream>
+#include <atomic>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <sstream>
+
+// counts every heap allocation of the process. Every new/delete form is
+// replaced so plain, array and aligned allocations all pair with free().
+std::atomic<size_t> allocations{0};
+
+void* counted_alloc(size_t size, size_t alignment = 0) {
+    ++allocations;
+    size = size ? size : 1;
+    void* p = alignment > alignof(std::max_align_t)
+        ? std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment)
+        : std::malloc(size);
+    if (!p) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void* operator new(size_t size) { return counted_alloc(size); }
+void* operator new[](size_t size) { return counted_alloc(size); }
+void* operator new(size_t size, std::align_val_t al) { return counted_alloc(size, size_t(al)); }
+void* operator new[](size_t size, std::align_val_t al) { return counted_alloc(size, size_t(al)); }
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+void operator delete[](void* p, size_t) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, size_t, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, size_t, std::align_val_t) noexcept { std::free(p); }
+
+template<typename A, typename B, typename = void>
+struct can_multiply : std::false_type {};
+
+template<typename A, typename B>
+struct can_multiply<A, B, std::void_t<decltype(std::declval<A>() * std::declval<B>())>> : std::true_type {};
+
+template<typename A, typename B, typename = void>
+struct can_add : std::false_type {};
+
+template<typename A, typename B>
+struct can_add<A, B, std::void_t<decltype(std::declval<A>() + std::declval<B>())>> : std::true_type {};
+
+// shape mismatches do not compile
+static_assert(can_multiply<fixed_matrix<float, 1, 2>, fixed_matrix<float, 2, 16>>::value, "");
+static_assert(!can_multiply<fixed_matrix<float, 1, 2>, fixed_matrix<float, 1, 16>>::value, "");
+static_assert(can_add<fixed_matrix<float, 2, 3>, fixed_matrix<float, 2, 3>>::value, "");
+static_assert(!can_add<fixed_matrix<float, 2, 3>, fixed_matrix<float, 3, 2>>::value, "");
+static_assert(fixed_matrix<float, 3, 5>::get_row() == 3 && fixed_matrix<float, 3, 5>::get_col() == 5, "");
+static_assert(alignof(fixed_matrix<double, 2, 16>) == 64, "");
+static_assert(sizeof(fixed_matrix<double, 2, 16>) == sizeof(double) * 32, "");
+static_assert(sizeof(fixed_matrix<float, 2, 3>) == 64, "");
+
+template<size_t R, size_t K, size_t C>
+void test_product() {
+    fixed_matrix<double, R, K> a;
+    fixed_matrix<double, K, C> b;
+    a.random_init();
+    b.random_init();
+
+    const fixed_matrix<double, R, C> c = a * b;
+    const matrix<double> expect = a.to_matrix() * b.to_matrix();
+    for (size_t i = 0; i < R; ++i)
+        for (size_t j = 0; j < C; ++j)
+            assert(std::abs(c[i][j] - expect[i][j]) < 1e-12);
+}
+
+template<size_t R, size_t K, size_t C>
+void test_transposed_product() {
+    fixed_matrix<double, K, R> at;
+    fixed_matrix<double, C, K> bt;
+    fixed_matrix<double, 1, C> v;
+    at.random_init();
+    bt.random_init();
+    v.random_init();
+
+    // must match the products of explicit transposes
+    const fixed_matrix<double, R, C> c = at.transpose_mul(bt.transpose());
+    const fixed_matrix<double, R, C> d = at.transpose().mul_transpose(bt);
+    const fixed_matrix<double, R, C> expect = at.transpose() * bt.transpose();
+    const fixed_matrix<double, R, C> shifted = expect.add_row(v);
+    for (size_t i = 0; i < R; ++i)
+        for (size_t j = 0; j < C; ++j) {
+            assert(std::abs(c[i][j] - expect[i][j]) < 1e-12);
+            assert(std::abs(d[i][j] - expect[i][j]) < 1e-12);
+            assert(shifted[i][j] == expect[i][j] + v[0][j]);
+        }
+}
+
+void test_elementwise() {
+    fixed_matrix<float, 3, 4> a, b;
+    a.random_init();
+    b.random_init();
+    const matrix<float> da = a.to_matrix(), db = b.to_matrix();
+
+    const matrix<float> expect = ((da + db).hadamard(db) * 2.0f - da).tanh();
+    const auto r = ((a + b).hadamard(b) * 2.0f - a).tanh();
+    for (size_t i = 0; i < 3; ++i)
+        for (size_t j = 0; j < 4; ++j)
+            assert(std::abs(r[i][j] - expect[i][j]) < 1e-6f);
+
+    assert(std::abs(a.pow(2).sum() - da.pow(2).sum()) < 1e-5f);
+
+    // above the unroll limit the sum is a simd reduction
+    fixed_matrix<double, 10, 30> big;
+    for (size_t i = 0; i < 10; ++i)
+        for (size_t j = 0; j < 30; ++j)
+            big[i][j] = static_cast<double>(i * 30 + j);
+    assert(big.sum() == 299.0 * 300 / 2);
+
+    const auto t = a.transpose();
+    for (size_t i = 0; i < 3; ++i)
+        for (size_t j = 0; j < 4; ++j)
+            assert(t[j][i] == a[i][j]);
+
+    a += b;
+    a -= b;
+    a *= 3.0f;
+    a /= 3.0f;
+    for (size_t i = 0; i < 3; ++i)
+        for (size_t j = 0; j < 4; ++j)
+            assert(std::abs(a[i][j] - da[i][j]) < 1e-6f);
+}
+
+void test_interop() {
+    matrix<float> m(2, 16);
+    m.random_init();
+    const fixed_matrix<float, 2, 16> f(m);
+    assert(f[1][15] == m[1][15]);
+    assert(f[2] == nullptr);
+
+    // views of fixed storage work with gemm and expressions
+    fixed_matrix<float, 1, 2> x;
+    x[0][0] = 0.5f;
+    x[0][1] = -1.0f;
+    fixed_matrix<float, 1, 16> y;
+    gemm<float>(y.view(), x.view(), f.view());
+    const auto expect = x * f;
+    for (size_t j = 0; j < 16; ++j)
+        assert(std::abs(y[0][j] - expect[0][j]) < 1e-6f);
+    const matrix<float> doubled = y.view() * 2.0f;
+    assert(doubled[0][3] == y[0][3] * 2.0f);
+
+    // same file format as matrix<T>
+    std::stringstream ss;
+    m.save(ss);
+    fixed_matrix<float, 2, 16> loaded;
+    loaded.load(ss);
+    assert(loaded[0][7] == m[0][7]);
+
+    bool thrown = false;
+    try {
+        fixed_matrix<float, 16, 2> wrong(m);
+    } catch (const std::runtime_error&) {
+        thrown = true;
+    }
+    assert(thrown);
+}
+
+// One bp.cpp training step and a batched forward pass stay off the heap.
+void test_no_heap() {
+    fixed_matrix<float, 2, 1> input;
+    fixed_matrix<float, 2, 16> hidden_weight;
+    fixed_matrix<float, 1, 16> hidden_bias;
+    fixed_matrix<float, 16, 1> output_weight;
+    fixed_matrix<float, 1, 1> output_bias, target;
+    fixed_matrix<float, 2, 4> batch;
+    input.random_init();
+    hidden_weight.random_init();
+    hidden_bias.random_init();
+    output_weight.random_init();
+    output_bias.random_init();
+    batch.random_init();
+
+    const size_t before = allocations;
+    const auto hidden = (input.transpose_mul(hidden_weight) + hidden_bias).tanh();
+    const auto output = (hidden * output_weight + output_bias).sigmoid();
+    const auto error = output - target;
+    const auto output_diff = output.sigmoid_derivative().hadamard(error * -0.25f);
+    output_weight += hidden.transpose_mul(output_diff);
+    output_bias += output_diff;
+    const auto hidden_diff = output_diff.mul_transpose(output_weight).hadamard(hidden.tanh_derivative());
+    hidden_weight += input * hidden_diff;
+    hidden_bias += hidden_diff;
+    const auto forward = (batch.transpose_mul(hidden_weight).add_row(hidden_bias).tanh() * output_weight)
+                             .add_row(output_bias).sigmoid();
+    const size_t count = allocations - before;
+    assert(count == 0);
+    assert(std::isfinite(error.pow(2).sum() + forward.sum()));
+}
+
+int main() {
+    test_product<1, 2, 16>();
+    test_product<1, 16, 1>();
+    test_product<16, 1, 1>();
+    test_product<5, 7, 3>();
+    test_product<4, 9, 20>();
+    std::cout << "Fixed Product Test Passed!" << std::endl;
+    test_transposed_product<1, 2, 16>();
+    test_transposed_product<16, 1, 1>();
+    test_transposed_product<1, 1, 16>();
+    test_transposed_product<4, 2, 16>();
+    test_transposed_product<5, 7, 3>();
+    test_transposed_product<4, 9, 20>();
+    std::cout << "Fixed Transposed Product Test Passed!" << std::endl;
+    test_elementwise();
+    std::cout << "Fixed Elementwise Test Passed!" << std::endl;
+    test_interop();
+    std::cout << "Fixed Interop Test Passed!" << std::endl;
+    test_no_heap();
+    std::cout << "Fixed No Heap Test Passed!" << std::endl;
+    std::cout << "All tests passed!" << std::endl;
+    return 0;
+}
@@ -0,0 +1,251 @@
+#include "matrix.hpp"
+#include <iostream>
+#include <cassert>
+#include <cmath>
+
+template<typename T>
+matrix<T> naive_mult(const matrix<T>& A, const matrix<T>& B) {
+    matrix<T> C(A.get_row(), B.get_col());
+    for (size_t i = 0; i < A.get_row(); ++i) {
+        for (size_t j = 0; j < B.get_col(); ++j) {
+            double sum = 0;
+            for (size_t k = 0; k < A.get_col(); ++k) {
+                sum += static_cast<double>(A[i][k]) * B[k][j];
+            }
+            C[i][j] = static_cast<T>(sum);
+        }
+    }
+    return C;
+}
+
+template<typename T>
+void check_close(const matrix<T>& result, const matrix<T>& expect, size_t k) {
+    assert(result.get_row() == expect.get_row());
+    assert(result.get_col() == expect.get_col());
+    const double tolerance = (std::is_same<T, float>::value ? 1e-5 : 1e-12) * k;
+    for (size_t i = 0; i < expect.get_row(); ++i) {
+        for (size_t j = 0; j < expect.get_col(); ++j) {
+            assert(std::abs(result[i][j] - expect[i][j]) < tolerance);
+        }
+    }
+}
+
+template<typename T>
+void test_shapes() {
+    // Odd shapes hit every edge tile of the packed kernel.
+    const size_t shapes[][3] = {
+        {1, 1, 1}, {1, 16, 2}, {16, 1, 16}, {7, 13, 5},
+        {37, 53, 41}, {129, 67, 300}, {300, 257, 513}
+    };
+    for (const auto& shape : shapes) {
+        matrix<T> A(shape[0], shape[2]);
+        matrix<T> B(shape[2], shape[1]);
+        A.random_init();
+        B.random_init();
+
+        auto expect = naive_mult(A, B);
+        check_close(A * B, expect, shape[2]);
+        check_close(A.mult_sequential(B), expect, shape[2]);
+    }
+}
+
+template<typename T>
+void test_gemm_api() {
+    const size_t shapes[][3] = {{1, 16, 2}, {16, 1, 16}, {37, 53, 41}, {129, 67, 300}};
+    for (const auto& shape : shapes) {
+        const size_t m = shape[0], n = shape[1], k = shape[2];
+        matrix<T> A(m, k), At(k, m), B(k, n), Bt(n, k), C0(m, n);
+        A.random_init();
+        B.random_init();
+        C0.random_init();
+        At = A.transpose();
+        Bt = B.transpose();
+
+        const T alpha = 0.5, beta = -2;
+        auto expect = naive_mult(A, B);
+        for (size_t i = 0; i < m; ++i)
+            for (size_t j = 0; j < n; ++j)
+                expect[i][j] = alpha * expect[i][j] + beta * C0[i][j];
+
+        for (int flags = 0; flags < 4; ++flags) {
+            const bool ta = flags & 1;
+            const bool tb = flags & 2;
+            matrix<T> C = C0;
+            C.gemm(ta ? At : A, tb ? Bt : B, alpha, beta, ta, tb);
+            check_close(C, expect, k);
+        }
+
+        // beta == 0 resizes the destination and ignores its content
+        matrix<T> D(1, 1);
+        D.gemm(A, Bt, 1, 0, false, true);
+        check_close(D, naive_mult(A, B), k);
+    }
+
+    // destination aliasing an operand
+    matrix<T> S(24, 24), I(24, 24);
+    S.random_init();
+    for (size_t i = 0; i < 24; ++i)
+        for (size_t j = 0; j < 24; ++j)
+            I[i][j] = i == j;
+    auto expect = naive_mult(S, S);
+    for (size_t i = 0; i < 24; ++i)
+        for (size_t j = 0; j < 24; ++j)
+            expect[i][j] += S[i][j];
+    S.gemm(S, I, 1, 0);
+    S.gemm(S, S, 1, 1);
+    check_close(S, expect, 24);
+}
+
+template<typename T>
+void test_transpose() {
+    // sizes around the register block and tile edges
+    const size_t shapes[][2] = {
+        {1, 1}, {1, 9}, {8, 8}, {9, 7}, {64, 64}, {65, 63}, {130, 257}, {300, 300}
+    };
+    for (const auto& shape : shapes) {
+        matrix<T> a(shape[0], shape[1]);
+        a.random_init();
+
+        const matrix<T> t = a.transpose();
+        assert(t.get_row() == a.get_col() && t.get_col() == a.get_row());
+        for (size_t i = 0; i < a.get_row(); ++i)
+            for (size_t j = 0; j < a.get_col(); ++j)
+                assert(t[j][i] == a[i][j]);
+
+        matrix<T> b = a;
+        b.transpose_inplace();
+        assert(b.get_row() == t.get_row() && b.get_col() == t.get_col());
+        for (size_t i = 0; i < t.get_row(); ++i)
+            for (size_t j = 0; j < t.get_col(); ++j)
+                assert(b[i][j] == t[i][j]);
+    }
+}
+
+template<typename T>
+void test_batched() {
+    // widths on both sides of the unrolled kernels, and one large item
+    const size_t shapes[][3] = {{1, 1, 1}, {1, 16, 2}, {1, 1, 16}, {3, 7, 5}, {4, 17, 4}, {40, 40, 40}};
+    for (const auto& shape : shapes) {
+        const size_t batch = 37;
+        std::vector<matrix<T>> A, B, C;
+        for (size_t i = 0; i < batch; ++i) {
+            A.emplace_back(shape[0], shape[2]);
+            B.emplace_back(shape[2], shape[1]);
+            A.back().random_init();
+            B.back().random_init();
+        }
+
+        gemm_batched(C, A, B);
+        assert(C.size() == batch);
+        for (size_t i = 0; i < batch; ++i) {
+            check_close(C[i], naive_mult(A[i], B[i]), shape[2]);
+        }
+
+        // shared B, accumulate into the previous result
+        gemm_batched(C, A, B[0], T(2), T(-1));
+        for (size_t i = 0; i < batch; ++i) {
+            check_close(C[i], matrix<T>(naive_mult(A[i], B[0]) * T(2) - naive_mult(A[i], B[i])), shape[2]);
+        }
+
+        // transposed operands through strides
+        std::vector<matrix<T>> At, Bt;
+        for (size_t i = 0; i < batch; ++i) {
+            At.push_back(A[i].transpose());
+            Bt.push_back(B[i].transpose());
+        }
+        gemm_batched(C, At, Bt, T(1), T(0), true, true);
+        for (size_t i = 0; i < batch; ++i) {
+            check_close(C[i], naive_mult(A[i], B[i]), shape[2]);
+        }
+
+        // strided batch over one contiguous buffer
+        matrix<T> As(batch * shape[0], shape[2]), Cs(batch * shape[0], shape[1]);
+        As.random_init();
+        gemm_batch<T>::strided(shape[0], shape[1], shape[2],
+                               As.data(), shape[2], 1, shape[0] * shape[2],
+                               B[0].data(), shape[1], 1, 0,
+                               Cs.data(), shape[1], shape[0] * shape[1],
+                               batch, T(1), T(0));
+        check_close(Cs, naive_mult(As, B[0]), shape[2]);
+    }
+
+    bool thrown = false;
+    try {
+        std::vector<matrix<T>> A(3, matrix<T>(2, 2)), B(2, matrix<T>(2, 2)), C;
+        gemm_batched(C, A, B);
+    } catch (const std::runtime_error&) {
+        thrown = true;
+    }
+    assert(thrown);
+}
+
+template<typename T>
+void test_vector_products() {
+    // k == 1 is an outer product, n == 1 or m == 1 a matrix-vector product
+    const size_t shapes[][3] = {
+        {300, 257, 1}, {5, 3, 1}, {513, 1, 300}, {7, 1, 13}, {1, 513, 300}, {1, 9, 5}, {1, 1, 1000}
+    };
+    for (const auto& shape : shapes) {
+        const size_t m = shape[0], n = shape[1], k = shape[2];
+        matrix<T> A(m, k), B(k, n), C0(m, n);
+        A.random_init();
+        B.random_init();
+        C0.random_init();
+        const matrix<T> At = A.transpose(), Bt = B.transpose();
+
+        const T alpha = 1.5, beta = 0.25;
+        const auto product = naive_mult(A, B);
+        auto expect = product;
+        for (size_t i = 0; i < m; ++i)
+            for (size_t j = 0; j < n; ++j)
+                expect[i][j] = alpha * product[i][j] + beta * C0[i][j];
+
+        for (int flags = 0; flags < 4; ++flags) {
+            const bool ta = flags & 1;
+            const bool tb = flags & 2;
+            matrix<T> C = C0;
+            C.gemm(ta ? At : A, tb ? Bt : B, alpha, beta, ta, tb);
+            check_close(C, expect, k);
+
+            // beta == 0 must not read the destination
+            matrix<T> D(m, n);
+            for (size_t i = 0; i < m; ++i)
+                for (size_t j = 0; j < n; ++j)
+                    D[i][j] = NAN;
+            D.gemm(ta ? At : A, tb ? Bt : B, 1, 0, ta, tb);
+            check_close(D, product, k);
+        }
+        check_close(A * B, product, k);
+    }
+
+    const size_t n = 1000;
+    matrix<T> x(1, n), y(1, n);
+    x.random_init();
+    y.random_init();
+    double dot = 0;
+    for (size_t i = 0; i < n; ++i)
+        dot += static_cast<double>(x[0][i]) * y[0][i];
+    assert(std::abs(gemv_kernel<T>::dot(n, x.data(), 1, y.data(), 1) - dot) < (std::is_same<T, float>::value ? 1e-5 : 1e-12) * n);
+
+    matrix<T> z = y;
+    gemv_kernel<T>::axpy(n, 2, x.data(), 1, z.data(), 1);
+    for (size_t i = 0; i < n; ++i)
+        assert(z[0][i] == T(2) * x[0][i] + y[0][i] || std::abs(z[0][i] - (2 * x[0][i] + y[0][i])) < 1e-6);
+}
+
+int main() {
+    test_shapes<float>();
+    test_gemm_api<float>();
+    test_transpose<float>();
+    test_batched<float>();
+    test_vector_products<float>();
+    std::cout << "GEMM float Test Passed!" << std::endl;
+    test_shapes<double>();
+    test_gemm_api<double>();
+    test_transpose<double>();
+    test_batched<double>();
+    test_vector_products<double>();
+    std::cout << "GEMM double Test Passed!" << std::endl;
+    std::cout << "All tests passed!" << std::endl;
+    return 0;
+}
@@ -0,0 +1,216 @@
+#include "matrix.hpp"
+#include "mapped_matrix.hpp"
+#include "fixed_matrix.hpp"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <cassert>
+#include <cstring>
+#include <cstdio>
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+template<typename F>
+bool throws(F f) {
+    try {
+        f();
+    } catch (const std::runtime_error&) {
+        return true;
+    }
+    return false;
+}
+
+template<typename T>
+bool same(const matrix<T>& a, const matrix<T>& b) {
+    return a.get_row() == b.get_row() && a.get_col() == b.get_col() &&
+           std::memcmp(a.data(), b.data(), sizeof(T) * a.get_row() * a.get_col()) == 0;
+}
+
+void test_round_trip() {
+    matrix<float> a(37, 53);
+    a.random_init(1);
+    matrix<double> b(5, 3);
+    b.random_normal(0, 1, 2);
+
+    std::stringstream ss;
+    ss.write("xyz", 3);
+    a.save(ss);
+    b.save(ss);
+    const std::string bytes = ss.str();
+
+    // header, then the data on a 64 byte boundary of the stream
+    assert(std::memcmp(bytes.data() + 3, "MTRX", 4) == 0);
+    assert(bytes[3 + 6] == 1);
+    uint32_t offset;
+    std::memcpy(&offset, bytes.data() + 3 + 8, sizeof(offset));
+    assert((3 + offset) % MATRIX_FILE_ALIGN == 0);
+    assert(std::memcmp(bytes.data() + 3 + offset, a.data(), sizeof(float) * 37 * 53) == 0);
+
+    ss.seekg(3);
+    matrix<float> a2(1, 1);
+    matrix<double> b2(1, 1);
+    a2.load(ss);
+    b2.load(ss);
+    assert(same(a, a2));
+    assert(same(b, b2));
+
+    // same element count, loads in place with the new shape
+    matrix<float> c(53, 37);
+    const float* buffer = c.data();
+    ss.seekg(3);
+    c.load(ss);
+    assert(c.data() == buffer);
+    assert(same(a, c));
+
+    // fixed_matrix reads the same records
+    fixed_matrix<double, 5, 3> f;
+    std::stringstream fs;
+    b.save(fs);
+    f.load(fs);
+    for (size_t i = 0; i < 5; ++i)
+        for (size_t j = 0; j < 3; ++j)
+            assert(f[i][j] == b[i][j]);
+    fs.seekg(0);
+    fixed_matrix<double, 3, 5> wrong;
+    assert(throws([&] { wrong.load(fs); }));
+
+    std::cout << "Round Trip Test Passed!" << std::endl;
+}
+
+void test_conversion() {
+    matrix<double> d(4, 6);
+    d.random_init(3);
+    std::stringstream ss;
+    d.save(ss);
+    matrix<float> f(1, 1);
+    f.load(ss);
+    assert(f.get_row() == 4 && f.get_col() == 6);
+    for (size_t i = 0; i < 4; ++i)
+        for (size_t j = 0; j < 6; ++j)
+            assert(f[i][j] == static_cast<float>(d[i][j]));
+
+    // the same record written on a host of the other byte order
+    std::string bytes = ss.str();
+    uint32_t offset;
+    std::memcpy(&offset, bytes.data() + 8, sizeof(offset));
+    bytes[7] = static_cast<char>(3 - host_byte_order());
+    std::reverse(&bytes[4], &bytes[4] + 2);
+    std::reverse(&bytes[8], &bytes[8] + 4);
+    std::reverse(&bytes[16], &bytes[16] + 8);
+    std::reverse(&bytes[24], &bytes[24] + 8);
+    for (size_t i = 0; i < 24; ++i)
+        std::reverse(&bytes[offset + i * 8], &bytes[offset + i * 8] + 8);
+    std::stringstream swapped(bytes);
+    matrix<double> d2(1, 1);
+    d2.load(swapped);
+    assert(same(d, d2));
+
+    std::cout << "Conversion Test Passed!" << std::endl;
+}
+
+void test_legacy_and_errors() {
+    // rows and cols as raw size_t, then the data
+    matrix<float> a(3, 4);
+    a.random_init(4);
+    std::stringstream legacy;
+    const size_t r = 3, c = 4;
+    legacy.write(reinterpret_cast<const char*>(&r), sizeof(r));
+    legacy.write(reinterpret_cast<const char*>(&c), sizeof(c));
+    legacy.write(reinterpret_cast<const char*>(a.data()), sizeof(float) * 12);
+    matrix<float> b(1, 1);
+    b.load(legacy);
+    assert(same(a, b));
+
+    std::stringstream ss;
+    a.save(ss);
+    const std::string bytes = ss.str();
+
+    std::string newer = bytes;
+    newer[4] = static_cast<char>(MATRIX_FILE_VERSION + 1);
+    newer[5] = 0;
+    std::stringstream newer_in(newer);
+    assert(throws([&] { b.load(newer_in); }));
+
+    std::stringstream truncated(bytes.substr(0, bytes.size() - 1));
+    assert(throws([&] { b.load(truncated); }));
+    std::stringstream short_header(bytes.substr(0, 20));
+    assert(throws([&] { b.load(short_header); }));
+
+    // rows * cols * 4 wraps to 16 bytes, which the data would cover
+    std::string huge = bytes;
+    const uint64_t huge_rows = (uint64_t(1) << 62) + 1, huge_cols = 4;
+    std::memcpy(&huge[16], &huge_rows, sizeof(huge_rows));
+    std::memcpy(&huge[24], &huge_cols, sizeof(huge_cols));
+    std::stringstream huge_in(huge);
+    assert(throws([&] { b.load(huge_in); }));
+    std::stringstream huge_legacy;
+    const size_t legacy_rows = SIZE_MAX / 2, legacy_cols = 3;
+    huge_legacy.write(reinterpret_cast<const char*>(&legacy_rows), sizeof(legacy_rows));
+    huge_legacy.write(reinterpret_cast<const char*>(&legacy_cols), sizeof(legacy_cols));
+    huge_legacy.write(reinterpret_cast<const char*>(a.data()), sizeof(float) * 12);
+    assert(throws([&] { b.load(huge_legacy); }));
+    {
+        std::ofstream out("test_io.tmp", std::ios::binary);
+        out << huge;
+    }
+    assert(throws([&] { mapped_matrix<float> m("test_io.tmp"); }));
+    std::remove("test_io.tmp");
+    assert(b.get_row() == 3 && b.get_col() == 4);
+
+    std::cout << "Legacy And Errors Test Passed!" << std::endl;
+}
+
+void test_mapped() {
+    const std::string path = "test_io.tmp";
+    matrix<float> a(100, 33), b(7, 9);
+    a.random_init(5);
+    b.random_init(6);
+    {
+        std::ofstream out(path, std::ios::binary);
+        a.save(out);
+        b.save(out);
+    }
+
+    mapped_matrix<float> m(path);
+    assert(m.get_row() == 100 && m.get_col() == 33);
+    assert(reinterpret_cast<uintptr_t>(m.data()) % MATRIX_FILE_ALIGN == 0);
+    assert(m[99][32] == a[99][32]);
+    assert(m[100] == nullptr);
+    assert(same(m.to_matrix(), a));
+    assert(throws([&] { m.mutable_view(); }));
+
+    // mapped data works in expressions like any other view
+    matrix<float> twice = m.view() * 2.0f;
+    assert(twice[10][10] == a[10][10] * 2.0f);
+
+    auto all = mapped_matrix<float>::map_all(path);
+    assert(all.size() == 2);
+    assert(same(all[0].to_matrix(), a));
+    assert(same(all[1].to_matrix(), b));
+
+    // copy-on-write pages never reach the file
+    {
+        mapped_matrix<float> cow(path, map_mode::copy_on_write);
+        cow.mutable_view() *= 2.0f;
+        assert(cow[0][0] == a[0][0] * 2.0f);
+    }
+    mapped_matrix<float> again(path);
+    assert(same(again.to_matrix(), a));
+
+    // other element types must be converted by load
+    assert(throws([&] { mapped_matrix<double> d(path); }));
+    assert(throws([&] { mapped_matrix<float> missing("test_io.missing"); }));
+    std::remove(path.c_str());
+
+    std::cout << "Mapped Test Passed!" << std::endl;
+}
+
+int main() {
+    test_round_trip();
+    test_conversion();
+    test_legacy_and_errors();
+    test_mapped();
+    std::cout << "All tests passed!" << std::endl;
+    return 0;
+}
@@ -0,0 +1,120 @@
+#include "matrix.hpp"
+#include <iostream>
+#include <cassert>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+#include <random>
+
+// Error of got in units of the last place of T around the reference value.
+template<typename T>
+long double ulp_error(T got, long double expect) {
+    const T e = static_cast<T>(expect);
+    const long double ulp = std::nextafter(std::abs(e), std::numeric_limits<T>::infinity()) - std::abs(e);
+    return std::abs(static_cast<long double>(got) - expect) / ulp;
+}
+
+template<typename T>
+void test_ulp(T lo, T hi, long double exp_ulp, long double tanh_ulp, long double sigmoid_ulp) {
+    std::mt19937_64 gen(42);
+    std::uniform_real_distribution<long double> dist(lo, hi);
+    long double max_exp = 0, max_tanh = 0, max_sigmoid = 0;
+    for (int i = 0; i < 1000000; ++i) {
+        const T x = static_cast<T>(dist(gen));
+        const long double lx = x;
+        max_exp = std::max(max_exp, ulp_error(fast_math<T>::exp(x), std::exp(lx)));
+        max_tanh = std::max(max_tanh, ulp_error(fast_math<T>::tanh(x), std::tanh(lx)));
+        max_sigmoid = std::max(max_sigmoid, ulp_error(fast_math<T>::sigmoid(x), 1 / (1 + std::exp(-lx))));
+    }
+    std::cout << "max ulp [" << lo << ", " << hi << "]: exp " << max_exp
+              << ", tanh " << max_tanh << ", sigmoid " << max_sigmoid << std::endl;
+    assert(max_exp <= exp_ulp);
+    assert(max_tanh <= tanh_ulp);
+    assert(max_sigmoid <= sigmoid_ulp);
+}
+
+template<typename T>
+void test_limits() {
+    const T inf = std::numeric_limits<T>::infinity();
+    assert(fast_math<T>::exp(0) == 1);
+    assert(std::isfinite(fast_math<T>::exp(inf)));
+    assert(fast_math<T>::exp(-inf) >= 0 && fast_math<T>::exp(-inf) <= 2 * std::numeric_limits<T>::min());
+    assert(fast_math<T>::tanh(0) == 0);
+    assert(fast_math<T>::tanh(inf) == 1 && fast_math<T>::tanh(-inf) == -1);
+    assert(fast_math<T>::sigmoid(inf) == 1 && fast_math<T>::sigmoid(-inf) >= 0);
+    assert(fast_math<T>::sigmoid(0) == T(0.5));
+
+    const T nan = std::numeric_limits<T>::quiet_NaN();
+    assert(std::isnan(fast_math<T>::exp(nan)) && std::isnan(fast_math<T>::exp(-nan)));
+    assert(std::isnan(fast_math<T>::tanh(nan)) && std::isnan(fast_math<T>::tanh(-nan)));
+    assert(std::isnan(fast_math<T>::sigmoid(nan)) && std::isnan(fast_math<T>::sigmoid(-nan)));
+}
+
+template<typename T>
+void test_modes() {
+    matrix<T> a(37, 29);
+    a.random_init();
+    a *= 6;
+
+    math_config::set_mode(math_mode::exact);
+    const matrix<T> exact_sigmoid = a.sigmoid();
+    const matrix<T> exact_tanh = a.tanh();
+    const matrix<T> exact_softmax = a.softmax();
+    for (size_t i = 0; i < a.get_row(); ++i) {
+        for (size_t j = 0; j < a.get_col(); ++j) {
+            assert(exact_sigmoid[i][j] == 1 / (1 + std::exp(-a[i][j])));
+            assert(exact_tanh[i][j] == std::tanh(a[i][j]));
+        }
+    }
+
+    math_config::set_mode(math_mode::fast);
+    const matrix<T> fast_sigmoid = a.sigmoid();
+    const matrix<T> fast_tanh = a.tanh();
+    const matrix<T> fast_softmax = a.softmax();
+    const T eps = std::numeric_limits<T>::epsilon();
+    for (size_t i = 0; i < a.get_row(); ++i) {
+        for (size_t j = 0; j < a.get_col(); ++j) {
+            assert(std::abs(fast_sigmoid[i][j] - exact_sigmoid[i][j]) <= 4 * eps);
+            assert(std::abs(fast_tanh[i][j] - exact_tanh[i][j]) <= 4 * eps);
+            assert(std::abs(fast_softmax[i][j] - exact_softmax[i][j]) <= 8 * eps);
+        }
+    }
+
+    // NaN survives the vectorized loops too
+    a[3][4] = std::numeric_limits<T>::quiet_NaN();
+    const matrix<T> nan_sigmoid = a.sigmoid();
+    const matrix<T> nan_tanh = a.tanh();
+    assert(std::isnan(nan_sigmoid[3][4]) && std::isnan(nan_tanh[3][4]));
+    assert(nan_sigmoid[3][5] == fast_sigmoid[3][5] && nan_tanh[3][5] == fast_tanh[3][5]);
+}
+
+// Without MATRIX_MATH_MODE existing code keeps the std::exp results.
+void test_default() {
+    if (std::getenv("MATRIX_MATH_MODE")) {
+        return;
+    }
+    assert(math_config::mode() == math_mode::exact);
+    matrix<float> a(1, 3);
+    a[0][0] = -1000;
+    a[0][1] = 0.3f;
+    a[0][2] = 1000;
+    const matrix<float> s = a.sigmoid();
+    assert(s[0][0] == 0 && s[0][1] == 1 / (1 + std::exp(-0.3f)) && s[0][2] == 1);
+    std::cout << "Default Mode Test Passed!" << std::endl;
+}
+
+int main() {
+    test_default();
+    test_ulp<float>(-87.0f, 88.0f, 2, 2, 3);
+    test_ulp<float>(-1.0f, 1.0f, 2, 2, 3);
+    test_limits<float>();
+    test_modes<float>();
+    std::cout << "Math float Test Passed!" << std::endl;
+    test_ulp<double>(-708.0, 709.0, 2, 2, 3);
+    test_ulp<double>(-1.0, 1.0, 2, 2, 3);
+    test_limits<double>();
+    test_modes<double>();
+    std::cout << "Math double Test Passed!" << std::endl;
+    std::cout << "All tests passed!" << std::endl;
+    return 0;
+}
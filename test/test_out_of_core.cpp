@@ -0,0 +1,141 @@
+#include "matrix.hpp"
+#include "out_of_core.hpp"
+#include <iostream>
+#include <fstream>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+
+template<typename T>
+void save_file(const matrix<T>& m, const std::string& path) {
+    std::ofstream out(path, std::ios::binary);
+    m.save(out);
+}
+
+template<typename T>
+matrix<T> load_file(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    matrix<T> m(1, 1);
+    m.load(in);
+    return m;
+}
+
+template<typename T>
+void check_close(const matrix<T>& result, const matrix<T>& expect, size_t k) {
+    assert(result.get_row() == expect.get_row());
+    assert(result.get_col() == expect.get_col());
+    const double tolerance = (std::is_same<T, float>::value ? 1e-5 : 1e-12) * k;
+    for (size_t i = 0; i < expect.get_row(); ++i)
+        for (size_t j = 0; j < expect.get_col(); ++j)
+            assert(std::abs(result[i][j] - expect[i][j]) < tolerance);
+}
+
+template<typename T>
+void test_tiled() {
+    const size_t shapes[][3] = {{1, 1, 1}, {37, 53, 41}, {300, 170, 513}, {129, 1, 300}};
+    // everything fits, a few tiles, tiny tiles with ragged edges
+    const size_t budgets[] = {static_cast<size_t>(256) << 20, 64 << 10, 5000 * sizeof(T)};
+    for (const auto& shape : shapes) {
+        matrix<T> A(shape[0], shape[2]), B(shape[2], shape[1]);
+        A.random_init(1);
+        B.random_init(2);
+        save_file(A, "test_ooc_a.tmp");
+        save_file(B, "test_ooc_b.tmp");
+        const matrix<T> expect = A * B * T(2);
+        for (const size_t budget : budgets) {
+            gemm_out_of_core<T>("test_ooc_a.tmp", "test_ooc_b.tmp", "test_ooc_c.tmp", budget, 2);
+            check_close(load_file<T>("test_ooc_c.tmp"), expect, shape[2]);
+        }
+    }
+
+    const auto tiling = out_of_core_tiling::choose<T>(10000, 10000, 10000, 64 << 20);
+    assert(tiling.tm < 10000 && tiling.tn < 10000);
+    assert((2 * (tiling.tm + tiling.tn) * tiling.tk + tiling.tm * tiling.tn) * sizeof(T) <= (64 << 20));
+}
+
+void test_errors() {
+    matrix<float> A(4, 5), B(6, 3);
+    A.random_init(3);
+    B.random_init(4);
+    save_file(A, "test_ooc_a.tmp");
+    save_file(B, "test_ooc_b.tmp");
+    bool thrown = false;
+    try {
+        gemm_out_of_core<float>("test_ooc_a.tmp", "test_ooc_b.tmp", "test_ooc_c.tmp");
+    } catch (const std::runtime_error&) {
+        thrown = true;
+    }
+    assert(thrown);
+
+    thrown = false;
+    try {
+        gemm_out_of_core<double>("test_ooc_a.tmp", "test_ooc_a.tmp", "test_ooc_c.tmp");
+    } catch (const std::runtime_error&) {
+        thrown = true;
+    }
+    assert(thrown);
+
+    thrown = false;
+    try {
+        gemm_out_of_core<float>("test_ooc_a.tmp", "test_ooc_a.tmp", "test_ooc_c.tmp", 8);
+    } catch (const std::runtime_error&) {
+        thrown = true;
+    }
+    assert(thrown);
+
+    // writing the product over an input must not touch the input
+    matrix<float> square(5, 5);
+    square.random_init(5);
+    save_file(square, "test_ooc_a.tmp");
+    save_file(square, "test_ooc_b.tmp");
+    thrown = false;
+    try {
+        gemm_out_of_core<float>("test_ooc_a.tmp", "test_ooc_b.tmp", "test_ooc_a.tmp");
+    } catch (const std::runtime_error&) {
+        thrown = true;
+    }
+    assert(thrown);
+    const matrix<float> kept = load_file<float>("test_ooc_a.tmp");
+    for (size_t i = 0; i < 5; ++i)
+        for (size_t j = 0; j < 5; ++j)
+            assert(kept[i][j] == square[i][j]);
+}
+
+void test_throughput() {
+    const size_t n = 1536;
+    matrix<float> A(n, n), B(n, n);
+    A.random_init(5);
+    B.random_init(6);
+    save_file(A, "test_ooc_a.tmp");
+    save_file(B, "test_ooc_b.tmp");
+
+    auto begin = std::chrono::steady_clock::now();
+    matrix<float> C = A * B;
+    const double in_memory = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+    // a budget of a third of the operands, forces several tiles
+    begin = std::chrono::steady_clock::now();
+    gemm_out_of_core<float>("test_ooc_a.tmp", "test_ooc_b.tmp", "test_ooc_c.tmp", n * n * sizeof(float));
+    const double tiled = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    check_close(load_file<float>("test_ooc_c.tmp"), C, n);
+
+    std::cout << "in memory: " << in_memory << " s, out of core: " << tiled << " s ("
+              << n << " x " << n << ")" << std::endl;
+}
+
+int main() {
+    test_tiled<float>();
+    test_tiled<double>();
+    std::cout << "Tiled Test Passed!" << std::endl;
+    test_errors();
+    std::cout << "Errors Test Passed!" << std::endl;
+    test_throughput();
+    std::remove("test_ooc_a.tmp");
+    std::remove("test_ooc_b.tmp");
+    std::remove("test_ooc_c.tmp");
+    std::cout << "All tests passed!" << std::endl;
+    return 0;
+}
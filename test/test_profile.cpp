@@ -0,0 +1,135 @@
+#include "matrix.hpp"
+#include "word2vec.hpp"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <cassert>
+#include <cstdio>
+#include <string>
+
+void test_counters() {
+    matrix_profiler& profiler = matrix_profiler::instance();
+    profiler.reset();
+
+    matrix<float> A(64, 32), B(32, 16);
+    A.random_init(1);
+    B.random_init(2);
+    matrix<float> C = A * B;
+    C = A * B;
+
+    const profile_stats gemm = profiler.get("gemm");
+    assert(gemm.calls == 2);
+    assert(gemm.flops == 2 * 2.0 * 64 * 32 * 16);
+    assert(gemm.bytes == 2 * sizeof(float) * (64 * 32 + 32 * 16 + 64 * 16));
+    // the result buffer is requested inside the gemm scope
+    assert(gemm.allocations >= 2);
+    assert(gemm.allocated_bytes >= 2 * sizeof(float) * 64 * 16);
+    assert(gemm.self_ns <= gemm.total_ns);
+
+    const profile_stats random = profiler.get("random_uniform");
+    assert(random.calls == 2 && random.allocations == 0);
+    assert(profiler.get("not_an_op").calls == 0);
+
+    std::cout << "Counters Test Passed!" << std::endl;
+}
+
+void test_nesting() {
+    matrix_profiler& profiler = matrix_profiler::instance();
+    profiler.reset();
+    {
+        MATRIX_PROFILE_SCOPE("outer", 10, 20);
+        matrix<double> a(100, 100);
+        a.random_init(3);
+        matrix<double> b = a.transpose();
+        b = b * a;
+    }
+    const profile_stats outer = profiler.get("outer");
+    const profile_stats gemm = profiler.get("gemm");
+    assert(outer.calls == 1 && outer.flops == 10 && outer.bytes == 20);
+    assert(outer.self_ns <= outer.total_ns);
+    assert(outer.total_ns >= gemm.total_ns);
+    // a's buffer belongs to outer, the gemm result to gemm
+    assert(outer.allocations >= 1);
+    assert(gemm.allocations >= 1);
+    assert(profiler.get("transpose").calls == 1);
+
+    std::cout << "Nesting Test Passed!" << std::endl;
+}
+
+// Forces OpenMP regions even on one core.
+void test_parallel_regions() {
+    matrix_profiler& profiler = matrix_profiler::instance();
+    profiler.reset();
+    const auto saved = parallel_dispatch::threshold(parallel_op::elementwise);
+    const int threads = omp_get_max_threads();
+    parallel_dispatch::set_threshold(parallel_op::elementwise, 0);
+    omp_set_num_threads(4);
+
+    matrix<float> a(256, 256);
+    a.random_init(4);
+    a *= 2.0f;
+    matrix<float> b = a * a;
+
+    assert(profiler.get("*=").parallel_regions == 1);
+    assert(profiler.get("gemm").parallel_regions >= 1);
+
+    omp_set_num_threads(threads);
+    parallel_dispatch::set_threshold(parallel_op::elementwise, saved);
+    std::cout << "Parallel Regions Test Passed!" << std::endl;
+}
+
+void test_report_and_trace() {
+    matrix_profiler& profiler = matrix_profiler::instance();
+    profiler.reset();
+    profiler.set_tracing(true);
+
+    Word2Vec<float>::TrainingConfig config;
+    config.embedding_dim = 16;
+    config.epochs = 2;
+    config.min_count = 1;
+    Word2Vec<float> model(config);
+    model.load_corpus("the quick brown fox jumps over the lazy dog the dog sleeps");
+    model.prepare_training_data();
+    std::streambuf* saved = std::cout.rdbuf(nullptr);
+    model.train();
+    std::cout.rdbuf(saved);
+    model.most_similar("dog", 3);
+
+    matrix<float> a(8, 8);
+    a.random_init(5);
+    matrix<float> b = a.softmax();
+    std::stringstream ss;
+    a.save(ss);
+
+    assert(profiler.get("w2v_train").calls == 1);
+    assert(profiler.get("w2v_epoch").calls == 2);
+    assert(profiler.get("w2v_epoch").total_ns <= profiler.get("w2v_train").total_ns);
+
+    std::ostringstream table;
+    profiler.report(table);
+    for (const char* name : {"operation", "w2v_train", "w2v_epoch", "w2v_most_similar", "softmax", "save"})
+        assert(table.str().find(name) != std::string::npos);
+
+    profiler.write_trace("test_profile_trace.json");
+    std::ifstream in("test_profile_trace.json");
+    std::stringstream trace;
+    trace << in.rdbuf();
+    assert(trace.str().find("\"traceEvents\"") != std::string::npos);
+    assert(trace.str().find("\"name\": \"w2v_epoch\", \"cat\": \"matrix\", \"ph\": \"X\"") != std::string::npos);
+    assert(trace.str().find("\"name\": \"softmax\"") != std::string::npos);
+    std::remove("test_profile_trace.json");
+
+    profiler.set_tracing(false);
+    profiler.reset();
+    assert(profiler.snapshot().empty());
+    std::cout << "Report and Trace Test Passed!" << std::endl;
+}
+
+int main() {
+    test_counters();
+    test_nesting();
+    test_parallel_regions();
+    test_report_and_trace();
+    std::cout << "All tests passed!" << std::endl;
+    return 0;
+}
@@ -0,0 +1,147 @@
+#include "matrix.hpp"
+#include "fixed_matrix.hpp"
+#include <iostream>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+
+void test_philox_known_answers() {
+    // Random123 kat_vectors for philox4x32_10
+    const uint32_t cases[3][10] = {
+        {0, 0, 0, 0, 0, 0,
+         0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8},
+        {0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff,
+         0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd},
+        {0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344, 0xa4093822, 0x299f31d0,
+         0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1}
+    };
+    for (const auto& c : cases) {
+        uint32_t out[4];
+        philox4x32::block(c[0], c[1], c[2], c[3], c[4], c[5], out);
+        for (int i = 0; i < 4; ++i)
+            assert(out[i] == c[6 + i]);
+    }
+    std::cout << "Philox Known Answer Test Passed!" << std::endl;
+}
+
+template<typename T>
+void test_thread_invariance() {
+    const size_t n = 100003;
+    matrix<T> a(1, n), b(1, n), c(1, 37);
+
+    // serial
+    const auto saved = parallel_dispatch::threshold(parallel_op::elementwise);
+    const auto saved_t = parallel_dispatch::threshold(parallel_op::transcendental);
+    const int threads = omp_get_max_threads();
+    parallel_dispatch::set_threshold(parallel_op::elementwise, static_cast<size_t>(-1));
+    parallel_dispatch::set_threshold(parallel_op::transcendental, static_cast<size_t>(-1));
+    a.random_init(7);
+    matrix<T> na(1, n);
+    na.random_normal(1, 2, 7);
+
+    // threaded
+    parallel_dispatch::set_threshold(parallel_op::elementwise, 0);
+    parallel_dispatch::set_threshold(parallel_op::transcendental, 0);
+    omp_set_num_threads(4);
+    b.random_init(7);
+    matrix<T> nb(1, n);
+    nb.random_normal(1, 2, 7);
+    omp_set_num_threads(threads);
+    parallel_dispatch::set_threshold(parallel_op::elementwise, saved);
+    parallel_dispatch::set_threshold(parallel_op::transcendental, saved_t);
+
+    assert(std::memcmp(a.data(), b.data(), sizeof(T) * n) == 0);
+    assert(std::memcmp(na.data(), nb.data(), sizeof(T) * n) == 0);
+
+    // element i only depends on (seed, i), a shorter fill is a prefix
+    c.random_init(7);
+    assert(std::memcmp(a.data(), c.data(), sizeof(T) * 37) == 0);
+
+    // another seed gives another stream
+    c.random_init(8);
+    size_t same = 0;
+    for (size_t i = 0; i < 37; ++i)
+        same += c[0][i] == a[0][i];
+    assert(same < 3);
+}
+
+template<typename T>
+void test_distributions() {
+    const size_t n = 1 << 20;
+    matrix<T> u(1024, n / 1024), g(1024, n / 1024);
+    u.random_uniform(-3, 5, 11);
+    g.random_normal(2, 3, 12);
+
+    double mean = 0, var = 0, gmean = 0, gvar = 0;
+    T lo = 5, hi = -3;
+    for (size_t i = 0; i < n; ++i) {
+        const double x = u.data()[i];
+        const double y = g.data()[i];
+        lo = std::min<T>(lo, u.data()[i]);
+        hi = std::max<T>(hi, u.data()[i]);
+        mean += x;
+        var += x * x;
+        gmean += y;
+        gvar += y * y;
+        assert(std::isfinite(y));
+    }
+    mean /= n;
+    var = var / n - mean * mean;
+    gmean /= n;
+    gvar = gvar / n - gmean * gmean;
+    assert(lo >= -3 && hi < 5);
+    assert(std::abs(mean - 1) < 0.02 && std::abs(var - 64.0 / 12) < 0.05);
+    assert(std::abs(gmean - 2) < 0.02 && std::abs(gvar - 9) < 0.1);
+
+    // xavier: uniform within +-sqrt(6 / (fan_in + fan_out))
+    matrix<T> w(300, 100);
+    w.xavier_init(13);
+    const T limit = std::sqrt(T(6) / T(400));
+    for (size_t i = 0; i < 300 * 100; ++i)
+        assert(std::abs(w.data()[i]) <= limit);
+
+    // he: stddev sqrt(2 / fan_in)
+    matrix<T> h(512, 512);
+    h.he_init(14);
+    double hvar = 0;
+    for (size_t i = 0; i < 512 * 512; ++i)
+        hvar += static_cast<double>(h.data()[i]) * h.data()[i];
+    hvar /= 512 * 512;
+    assert(std::abs(hvar - 2.0 / 512) < 0.05 * 2.0 / 512);
+}
+
+void test_default_seeds() {
+    random_config::set_seed(42);
+    matrix<float> a(16, 16), b(16, 16);
+    a.random_init();
+    b.random_init();
+    assert(std::memcmp(a.data(), b.data(), sizeof(float) * 256) != 0);
+
+    // restarting the sequence replays it
+    random_config::set_seed(42);
+    matrix<float> c(16, 16), d(16, 16);
+    c.random_init();
+    d.random_init();
+    assert(std::memcmp(a.data(), c.data(), sizeof(float) * 256) == 0);
+    assert(std::memcmp(b.data(), d.data(), sizeof(float) * 256) == 0);
+
+    fixed_matrix<float, 4, 4> f;
+    f.random_init(7);
+    matrix<float> m(4, 4);
+    m.random_init(7);
+    assert(std::memcmp(f.data(), m.data(), sizeof(float) * 16) == 0);
+    std::cout << "Default Seed Test Passed!" << std::endl;
+}
+
+int main() {
+    test_philox_known_answers();
+    test_thread_invariance<float>();
+    test_distributions<float>();
+    std::cout << "Random float Test Passed!" << std::endl;
+    test_thread_invariance<double>();
+    test_distributions<double>();
+    std::cout << "Random double Test Passed!" << std::endl;
+    test_default_seeds();
+    std::cout << "All tests passed!" << std::endl;
+    return 0;
+}
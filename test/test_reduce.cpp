@@ -0,0 +1,116 @@
+#include "matrix.hpp"
+#include <iostream>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+// Runs f once serially and once split across 4 threads, both results must match bit for bit.
+template<typename F>
+void check_thread_invariant(F f) {
+    const auto saved_r = parallel_dispatch::threshold(parallel_op::reduction);
+    const auto saved_t = parallel_dispatch::threshold(parallel_op::transcendental);
+    const int threads = omp_get_max_threads();
+
+    parallel_dispatch::set_threshold(parallel_op::reduction, static_cast<size_t>(-1));
+    parallel_dispatch::set_threshold(parallel_op::transcendental, static_cast<size_t>(-1));
+    const auto serial = f();
+
+    parallel_dispatch::set_threshold(parallel_op::reduction, 0);
+    parallel_dispatch::set_threshold(parallel_op::transcendental, 0);
+    omp_set_num_threads(4);
+    const auto threaded = f();
+    omp_set_num_threads(3);
+    const auto odd = f();
+
+    omp_set_num_threads(threads);
+    parallel_dispatch::set_threshold(parallel_op::reduction, saved_r);
+    parallel_dispatch::set_threshold(parallel_op::transcendental, saved_t);
+    assert(serial == threaded);
+    assert(serial == odd);
+}
+
+template<typename T>
+std::vector<T> values(const matrix<T>& m) {
+    return std::vector<T>(m.data(), m.data() + m.get_row() * m.get_col());
+}
+
+void test_determinism() {
+    matrix<float> a(1000, 1531), b(1000, 1531);
+    a.random_init(1);
+    b.random_init(2);
+    matrix<float> labels(1000, 1531);
+    labels.random_uniform(0, 1, 3);
+
+    check_thread_invariant([&] { return a.sum(); });
+    check_thread_invariant([&] { return (a - b).pow(2).sum(); });
+    check_thread_invariant([&] { return a.block(3, 7, 900, 1500).sum(); });
+    check_thread_invariant([&] { return a.view().transpose().sum(); });
+    check_thread_invariant([&] { return values(a.l1_normalize()); });
+    check_thread_invariant([&] { return values(a.l2_normalize()); });
+    check_thread_invariant([&] { return values(a.sum(reduce_axis::rows)); });
+    check_thread_invariant([&] { return values(a.hadamard(b).mean(reduce_axis::cols)); });
+    check_thread_invariant([&] { return softmax_cross_entropy(a, labels).loss; });
+
+    std::cout << "Determinism Test Passed!" << std::endl;
+}
+
+void test_accuracy() {
+    // 2^24 floats: a running float sum stalls once it is 2^24 times larger than each term
+    const size_t n = 1 << 24;
+    matrix<float> a(1 << 12, n >> 12);
+    a.random_uniform(0.05f, 0.15f, 4);
+    double expect = 0;
+    for (size_t i = 0; i < n; ++i)
+        expect += a.data()[i];
+    assert(std::abs(a.sum() - expect) / expect < 1e-6);
+    assert(std::abs(a.sum(reduce_axis::rows).sum() - expect) / expect < 1e-6);
+
+    // the same through the 2d path, narrow and wide rows
+    matrix<float> narrow(1 << 20, 16);
+    narrow.random_uniform(0.05f, 0.15f, 5);
+    expect = 0;
+    for (size_t i = 0; i < narrow.get_row() * narrow.get_col(); ++i)
+        expect += narrow.data()[i];
+    assert(std::abs(narrow.view().block(0, 0, 1 << 20, 16).sum() - expect) / expect < 1e-6);
+    assert(std::abs(narrow.view().transpose().sum() - expect) / expect < 1e-6);
+
+    std::cout << "Accuracy Test Passed!" << std::endl;
+}
+
+void test_norm_range() {
+    // squares overflow (1e30^2) or underflow (1e-30^2, 1e-40 is subnormal) in float
+    const float scales[] = {1e30f, 1e-30f, 1e-40f, 1.0f};
+    for (const float scale : scales) {
+        matrix<float> v(1, 4);
+        v[0][0] = 3 * scale;
+        v[0][1] = 0;
+        v[0][2] = -4 * scale;
+        v[0][3] = 0;
+        const matrix<float> u = v.l2_normalize();
+        assert(std::abs(u[0][0] - 0.6f) < 1e-6f);
+        assert(std::abs(u[0][2] + 0.8f) < 1e-6f);
+        assert(u[0][1] == 0 && u[0][3] == 0);
+
+        const float norm = reduce_kernel<float>::norm2(4, [&](size_t i) { return v.data()[i]; });
+        assert(std::abs(norm / (5 * scale) - 1) < 1e-6f);
+    }
+
+    matrix<double> big(1, 3);
+    big[0][0] = 1e300;
+    big[0][1] = 1e300;
+    big[0][2] = -1e300;
+    const double norm = reduce_kernel<double>::norm2(3, [&](size_t i) { return big.data()[i]; });
+    assert(std::abs(norm / (std::sqrt(3.0) * 1e300) - 1) < 1e-15);
+    assert(reduce_kernel<double>::norm2(0, [](size_t) { return 1.0; }) == 0);
+
+    std::cout << "Norm Range Test Passed!" << std::endl;
+}
+
+int main() {
+    test_determinism();
+    test_accuracy();
+    test_norm_range();
+    std::cout << "All tests passed!" << std::endl;
+    return 0;
+}
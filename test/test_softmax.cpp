@@ -49,6 +49,57 @@ void test_softmax_cross_entropy_gradient() {
     std::cout << "Softmax Cross Entropy Gradient Test Passed!" << std::endl;
 }
 
+void test_online_softmax() {
+    // a wide spread of magnitudes, so the running max is replaced often
+    matrix<double> logits(37, 1000);
+    logits.random_init();
+    logits *= 300;
+    logits[3][999] = 800;
+
+    matrix<double> result = logits.softmax();
+    for (size_t i = 0; i < logits.get_row(); ++i) {
+        double max_val = logits[i][0];
+        for (size_t j = 1; j < logits.get_col(); ++j) {
+            max_val = std::max(max_val, logits[i][j]);
+        }
+        double sum = 0;
+        for (size_t j = 0; j < logits.get_col(); ++j) {
+            sum += std::exp(logits[i][j] - max_val);
+        }
+        for (size_t j = 0; j < logits.get_col(); ++j) {
+            assert(std::abs(result[i][j] - std::exp(logits[i][j] - max_val) / sum) < 1e-12);
+        }
+    }
+
+    std::cout << "Online Softmax Test Passed!" << std::endl;
+}
+
+void test_fused_softmax_cross_entropy() {
+    matrix<double> logits(19, 21);
+    logits.random_init();
+    logits *= 10;
+
+    matrix<double> label(19, 21);
+    for (size_t i = 0; i < label.get_row(); ++i) {
+        label[i][(i * 7) % label.get_col()] = 1;
+    }
+
+    const auto result = softmax_cross_entropy(logits, label);
+    const matrix<double> output = logits.softmax();
+    const matrix<double> gradient = output.softmax_cross_entropy_gradient(label);
+
+    double loss = 0;
+    for (size_t i = 0; i < label.get_row(); ++i) {
+        for (size_t j = 0; j < label.get_col(); ++j) {
+            loss -= label[i][j] * std::log(output[i][j]);
+            assert(std::abs(result.gradient[i][j] - gradient[i][j]) < 1e-12);
+        }
+    }
+    assert(std::abs(result.loss - loss) < 1e-9);
+
+    std::cout << "Fused Softmax Cross Entropy Test Passed!" << std::endl;
+}
+
 int main() {
     // Create a test matrix
     matrix<double> test_matrix(2, 3);
@@ -64,6 +115,8 @@ int main() {
 
     test_large_softmax();
     test_softmax_cross_entropy_gradient();
+    test_online_softmax();
+    test_fused_softmax_cross_entropy();
     std::cout << "All tests passed!" << std::endl;
     return 0;
 }
\ No newline at end of file
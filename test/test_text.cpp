@@ -0,0 +1,247 @@
+#include "matrix.hpp"
+#include "fixed_matrix.hpp"
+#include <iostream>
+#include <sstream>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+template<typename T>
+bool same(const matrix<T>& a, const matrix<T>& b) {
+    return a.get_row() == b.get_row() && a.get_col() == b.get_col() &&
+           std::memcmp(a.data(), b.data(), sizeof(T) * a.get_row() * a.get_col()) == 0;
+}
+
+// A stream that cannot seek, like std::cin or a pipe.
+class forward_only: public std::streambuf {
+private:
+    std::string text;
+
+public:
+    explicit forward_only(const std::string& t): text(t) {
+        setg(&text[0], &text[0], &text[0] + text.size());
+    }
+};
+
+template<typename T>
+void test_round_trip() {
+    matrix<T> a(123, 77);
+    a.random_normal(0, 1000, 1);
+    a[0][0] = std::numeric_limits<T>::min();
+    a[0][1] = std::numeric_limits<T>::max();
+    a[0][2] = -std::numeric_limits<T>::denorm_min();
+    a[0][3] = 0;
+
+    std::stringstream ss;
+    ss << a;
+    matrix<T> b(123, 77);
+    ss >> b;
+    assert(ss);
+    assert(same(a, b));
+
+    // one row per line, shortest form
+    std::stringstream small;
+    matrix<T> c(2, 3);
+    c[0][0] = 0.1f; c[0][1] = 2; c[0][2] = -0.5f;
+    c[1][0] = 1e-3f; c[1][1] = 100; c[1][2] = 3.25f;
+    small << c;
+    const std::string expect = std::is_same<T, float>::value
+        ? "0.1 2 -0.5\n0.001 100 3.25\n"
+        : "0.10000000149011612 2 -0.5\n0.0010000000474974513 100 3.25\n";
+    assert(small.str() == expect);
+
+    // CSV, shape from the text
+    std::stringstream csv;
+    a.save_text(csv, ',');
+    assert(csv.str().find(',') != std::string::npos);
+    matrix<T> d(1, 1);
+    d.load_text(csv);
+    assert(same(a, d));
+}
+
+void test_streams() {
+    // two matrices back to back, each read stops right after its numbers
+    std::stringstream ss("1 2\n3 4\n5,6,7\n  8 9 10 tail");
+    matrix<double> a(2, 2), b(2, 3);
+    ss >> a >> b;
+    assert(ss);
+    assert(a[1][1] == 4 && b[0][0] == 5 && b[1][2] == 10);
+    std::string rest;
+    ss >> rest;
+    assert(rest == "tail");
+
+    // a leading '+' is accepted as by in >> float
+    std::stringstream plus("+1.5 2\n-3 +4e1");
+    matrix<float> p(2, 2);
+    plus >> p;
+    assert(plus);
+    assert(p[0][0] == 1.5f && p[0][1] == 2 && p[1][0] == -3 && p[1][1] == 40);
+    forward_only plus_buf("+0.5 +7");
+    std::istream plus_in(&plus_buf);
+    matrix<float> q(1, 2);
+    plus_in >> q;
+    assert(!plus_in.fail() && q[0][0] == 0.5f && q[0][1] == 7);
+    std::stringstream plus_minus("+-1 2");
+    matrix<float> r(1, 2);
+    plus_minus >> r;
+    assert(plus_minus.fail());
+
+    // tokens longer than any fixed buffer stay one number
+    const std::string long_number = "0." + std::string(200, '0') + "25e201";
+    forward_only long_buf(long_number + " 3\n-" + long_number + " 4");
+    std::istream long_in(&long_buf);
+    matrix<double> l(2, 2);
+    long_in >> l;
+    assert(long_in);
+    assert(l[0][0] == 2.5 && l[0][1] == 3 && l[1][0] == -2.5 && l[1][1] == 4);
+    std::stringstream long_seek(long_number + " 3");
+    matrix<double> l2(1, 2);
+    long_seek >> l2;
+    assert(long_seek && l2[0][0] == 2.5 && l2[0][1] == 3);
+
+    // missing numbers set failbit
+    std::stringstream short_in("1 2 3");
+    matrix<float> c(2, 2);
+    short_in >> c;
+    assert(!short_in);
+
+    // not seekable, read number by number
+    forward_only buf("0.25 -1e3\n7 8 next");
+    std::istream in(&buf);
+    matrix<float> e(2, 2);
+    in >> e;
+    assert(in);
+    assert(e[0][0] == 0.25f && e[0][1] == -1000 && e[1][1] == 8);
+    in >> rest;
+    assert(rest == "next");
+
+    // across block boundaries of the buffered reader
+    matrix<float> big(1, (text_codec<float>::READ_BLOCK / 4) + 3);
+    big.random_init(2);
+    std::stringstream big_text;
+    big_text << big << big;
+    matrix<float> big2(big.get_row(), big.get_col()), big3(big.get_row(), big.get_col());
+    big_text >> big2 >> big3;
+    assert(same(big, big2));
+    assert(same(big, big3));
+
+    // small writes, whatever CHUNK is
+    matrix<double> one(1, 1);
+    one[0][0] = 0.125;
+    std::stringstream one_text;
+    one_text << one;
+    assert(one_text.str() == "0.125\n");
+
+    fixed_matrix<float, 1, 2> f;
+    f[0][0] = 1.5f;
+    f[0][1] = -2;
+    std::stringstream fs;
+    fs << f;
+    assert(fs.str() == "1.5 -2\n");
+
+    std::cout << "Streams Test Passed!" << std::endl;
+}
+
+void test_errors() {
+    // operator>> sets failbit like iostream, the bulk API throws
+    std::stringstream bad("1 2 x3 4");
+    matrix<float> a(2, 2);
+    bad >> a;
+    assert(bad.fail());
+    forward_only bad_buf("1 2 x3 4");
+    std::istream bad_in(&bad_buf);
+    bad_in >> a;
+    assert(bad_in.fail());
+
+    bool thrown = false;
+    std::stringstream bad_csv("1,2\nx3,4\n");
+    try {
+        a.load_text(bad_csv);
+    } catch (const std::runtime_error& e) {
+        thrown = std::string(e.what()).find("x3") != std::string::npos;
+    }
+    assert(thrown);
+
+    thrown = false;
+    std::stringstream ragged("1 2\n3\n");
+    try {
+        a.load_text(ragged);
+    } catch (const std::runtime_error&) {
+        thrown = true;
+    }
+    assert(thrown);
+
+    std::stringstream empty("\n\n");
+    a.load_text(empty);
+    assert(a.get_row() == 0 && a.get_col() == 0);
+
+    std::cout << "Errors Test Passed!" << std::endl;
+}
+
+void test_speed() {
+    matrix<float> a(2000, 1000), b(2000, 1000);
+    a.random_init(3);
+
+    auto begin = std::chrono::steady_clock::now();
+    std::stringstream old_out;
+    for (size_t i = 0; i < a.get_row(); ++i)
+        for (size_t j = 0; j < a.get_col(); ++j)
+            old_out << a[i][j] << (j == a.get_col() - 1 ? '\n' : ' ');
+    const double old_write = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+    begin = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < b.get_row(); ++i)
+        for (size_t j = 0; j < b.get_col(); ++j)
+            old_out >> b[i][j];
+    const double old_read = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+    begin = std::chrono::steady_clock::now();
+    std::stringstream ss;
+    ss << a;
+    const double write = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+    begin = std::chrono::steady_clock::now();
+    ss >> b;
+    const double read = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    assert(same(a, b));
+
+    std::cout << "iostream write " << old_write << " s, read " << old_read << " s; "
+              << "text_codec write " << write << " s, read " << read << " s (2000 x 1000)" << std::endl;
+}
+
+// Forces the chunked paths with several pieces even on one core.
+void test_threaded() {
+    const auto saved = parallel_dispatch::threshold(parallel_op::transcendental);
+    const int threads = omp_get_max_threads();
+    parallel_dispatch::set_threshold(parallel_op::transcendental, 0);
+    omp_set_num_threads(4);
+
+    test_round_trip<float>();
+    test_round_trip<double>();
+    std::stringstream ss("1,2 3\n4\t5 6\n\n7 8 9\n");
+    matrix<float> a(1, 1);
+    a.load_text(ss);
+    assert(a.get_row() == 3 && a.get_col() == 3);
+    for (size_t i = 0; i < 9; ++i)
+        assert(a.data()[i] == i + 1);
+
+    omp_set_num_threads(threads);
+    parallel_dispatch::set_threshold(parallel_op::transcendental, saved);
+    std::cout << "Threaded Test Passed!" << std::endl;
+}
+
+int main() {
+    test_round_trip<float>();
+    test_round_trip<double>();
+    std::cout << "Round Trip Test Passed!" << std::endl;
+    test_threaded();
+    test_streams();
+    test_errors();
+    test_speed();
+    std::cout << "All tests passed!" << std::endl;
+    return 0;
+}
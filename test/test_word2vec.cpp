@@ -0,0 +1,281 @@
+#include "word2vec.hpp"
+#include <iostream>
+#include <sstream>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <random>
+#include <string>
+
+// counts every heap allocation of the process. Every new/delete form is
+// replaced so plain, array and aligned allocations all pair with free().
+std::atomic<size_t> allocations{0};
+
+void* counted_alloc(size_t size, size_t alignment = 0) {
+    ++allocations;
+    size = size ? size : 1;
+    void* p = alignment > alignof(std::max_align_t)
+        ? std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment)
+        : std::malloc(size);
+    if (!p) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void* operator new(size_t size) { return counted_alloc(size); }
+void* operator new[](size_t size) { return counted_alloc(size); }
+void* operator new(size_t size, std::align_val_t al) { return counted_alloc(size, size_t(al)); }
+void* operator new[](size_t size, std::align_val_t al) { return counted_alloc(size, size_t(al)); }
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+void operator delete[](void* p, size_t) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, size_t, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, size_t, std::align_val_t) noexcept { std::free(p); }
+
+// Two topics with disjoint words, written in blocks of 50 words, so the
+// neighbours of a word are almost always from its own topic.
+std::string topic_corpus(size_t tokens) {
+    const char* topics[2][8] = {
+        {"apple", "banana", "cherry", "grape", "lemon", "mango", "peach", "plum"},
+        {"engine", "wheel", "brake", "clutch", "piston", "gear", "axle", "valve"},
+    };
+    std::mt19937 gen(7);
+    std::uniform_int_distribution<int> word(0, 7);
+    std::string text;
+    for (size_t i = 0; i < tokens; ++i) {
+        text += topics[(i / 50) % 2][word(gen)];
+        text += ' ';
+    }
+    return text;
+}
+
+size_t same_topic(const std::vector<std::pair<std::string, float>>& similar, const std::string& topic_words) {
+    size_t count = 0;
+    for (const auto& entry : similar)
+        count += topic_words.find(entry.first) != std::string::npos;
+    return count;
+}
+
+double train_seconds(size_t threads, const std::string& corpus, Word2Vec<float>*& model, bool shared = false) {
+    Word2Vec<float>::TrainingConfig config;
+    config.embedding_dim = 32;
+    config.window_size = 3;
+    config.negative_samples = 3;
+    config.epochs = 4;
+    config.threads = threads;
+    config.shared_negatives = shared;
+    model = new Word2Vec<float>(config);
+    model->load_corpus(corpus);
+    model->prepare_training_data();
+
+    std::ostringstream quiet;
+    std::streambuf* saved = std::cout.rdbuf(quiet.rdbuf());
+    const auto begin = std::chrono::steady_clock::now();
+    model->train();
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    std::cout.rdbuf(saved);
+    return seconds;
+}
+
+template<typename T>
+void test_kernel() {
+    using kernel = skip_gram_kernel<T>;
+    std::mt19937 gen(3);
+    std::uniform_real_distribution<T> value(-1, 1);
+    for (size_t n : {1, 7, 16, 33, 100, 301}) {
+        std::vector<T> a(n), b(n), y(n);
+        for (size_t i = 0; i < n; ++i) {
+            a[i] = value(gen);
+            b[i] = value(gen);
+            y[i] = b[i];
+        }
+        double dot = 0;
+        for (size_t i = 0; i < n; ++i)
+            dot += static_cast<double>(a[i]) * b[i];
+        assert(std::abs(kernel::dot(a.data(), b.data(), n) - dot) < 1e-4 * n);
+        kernel::axpy(T(0.5), a.data(), y.data(), n);
+        for (size_t i = 0; i < n; ++i)
+            assert(std::abs(y[i] - (b[i] + T(0.5) * a[i])) < 1e-6);
+    }
+    for (double x = -8; x <= 8; x += 0.01) {
+        const double sigmoid = 1 / (1 + std::exp(-x));
+        assert(std::abs(kernel::sigmoid(static_cast<T>(x)) - sigmoid) < 3e-3);
+        assert(std::abs(kernel::log_sigmoid(static_cast<T>(x)) - std::log(sigmoid)) < 1e-2);
+    }
+}
+
+void test_hogwild() {
+    const std::string corpus = topic_corpus(40000);
+    const std::string fruit = "apple banana cherry grape lemon mango peach plum";
+    const std::string parts = "engine wheel brake clutch piston gear axle valve";
+
+    for (size_t run = 0; run < 4; ++run) {
+        Word2Vec<float>* model = nullptr;
+        train_seconds(run % 2 ? 4 : 1, corpus, model, run >= 2);
+
+        const auto& losses = model->get_epoch_losses();
+        assert(losses.size() == 4);
+        assert(losses.back() < losses.front());
+        for (float loss : losses)
+            assert(std::isfinite(loss));
+
+        assert(same_topic(model->most_similar("apple", 5), fruit) >= 4);
+        assert(same_topic(model->most_similar("piston", 5), parts) >= 4);
+        delete model;
+    }
+    std::cout << "Hogwild Test Passed!" << std::endl;
+}
+
+void test_small() {
+    // fewer tokens than threads, in double
+    Word2Vec<double>::TrainingConfig config;
+    config.embedding_dim = 19;
+    config.epochs = 2;
+    config.threads = 16;
+    Word2Vec<double> w2v(config);
+    w2v.load_corpus("one two three");
+    w2v.prepare_training_data();
+    std::ostringstream quiet;
+    std::streambuf* saved = std::cout.rdbuf(quiet.rdbuf());
+    w2v.train();
+    std::cout.rdbuf(saved);
+    assert(w2v.get_epoch_losses().size() == 2);
+    std::cout << "Small Corpus Test Passed!" << std::endl;
+}
+
+// Called from inside a parallel region with nesting off, train() gets a
+// team of one thread for four ranges. Words that only occur in the last
+// range must still be trained.
+void test_small_team() {
+    std::string corpus = topic_corpus(3000);
+    for (size_t i = 0; i < 1000; ++i)
+        corpus += i % 2 ? "tail " : "end ";
+    Word2Vec<float>::TrainingConfig config;
+    config.embedding_dim = 16;
+    config.epochs = 1;
+    config.threads = 4;
+    Word2Vec<float> w2v(config);
+    w2v.load_corpus(corpus);
+    std::ostringstream quiet;
+    std::streambuf* saved = std::cout.rdbuf(quiet.rdbuf());
+    w2v.prepare_training_data();
+    w2v.initialize_embeddings();
+    const std::vector<float> before = w2v.get_word_vector("tail");
+
+    const int levels = omp_get_max_active_levels();
+    omp_set_max_active_levels(1);
+    #pragma omp parallel num_threads(2)
+    {
+        #pragma omp single
+        {
+            assert(omp_in_parallel());
+            w2v.train();
+        }
+    }
+    omp_set_max_active_levels(levels);
+    std::cout.rdbuf(saved);
+    assert(w2v.get_word_vector("tail") != before);
+    std::cout << "Small Team Test Passed!" << std::endl;
+}
+
+// The skip-gram loop itself never allocates, whatever the corpus size.
+void test_allocations(bool shared) {
+    Word2Vec<float>::TrainingConfig config;
+    config.embedding_dim = 50;
+    config.epochs = 3;
+    config.threads = 1;
+    config.shared_negatives = shared;
+    Word2Vec<float> w2v(config);
+    w2v.load_corpus(topic_corpus(20000));
+    w2v.prepare_training_data();
+    w2v.initialize_embeddings();
+
+    std::ostringstream quiet;
+    quiet.str(std::string(4096, ' '));
+    std::streambuf* saved = std::cout.rdbuf(quiet.rdbuf());
+    const size_t before = allocations;
+    w2v.train();
+    const size_t count = allocations - before;
+    std::cout.rdbuf(saved);
+    assert(count < 20 * config.epochs);
+    std::cout << "Allocations Test Passed! (" << count << " for 20000 tokens x 3 epochs"
+              << (shared ? ", shared negatives)" : ")") << std::endl;
+}
+
+void test_throughput() {
+    const std::string corpus = topic_corpus(200000);
+    Word2Vec<float>* model = nullptr;
+    const double one = train_seconds(1, corpus, model);
+    delete model;
+    const size_t threads = static_cast<size_t>(omp_get_num_procs());
+    const double all = train_seconds(threads, corpus, model);
+    delete model;
+    std::cout << "1 thread: " << one << " s, " << threads << " threads: " << all << " s (speedup "
+              << one / all << ", 200000 tokens x 4 epochs)" << std::endl;
+}
+
+// With one word every negative equals the context and is skipped, so only
+// the positives are scored: about -log(sigmoid(0)) each at a tiny rate.
+void test_skipped_negatives() {
+    std::string corpus;
+    for (size_t i = 0; i < 2000; ++i)
+        corpus += "same ";
+    for (bool shared : {false, true}) {
+        Word2Vec<float>::TrainingConfig config;
+        config.embedding_dim = 8;
+        config.epochs = 1;
+        config.threads = 1;
+        config.learning_rate = 1e-5f;
+        config.subsample_threshold = 0;
+        config.shared_negatives = shared;
+        Word2Vec<float> w2v(config);
+        w2v.load_corpus(corpus);
+        std::ostringstream quiet;
+        std::streambuf* saved = std::cout.rdbuf(quiet.rdbuf());
+        w2v.prepare_training_data();
+        w2v.train();
+        std::cout.rdbuf(saved);
+        assert(std::abs(w2v.get_epoch_losses()[0] - std::log(2.0f)) < 0.02f);
+    }
+    std::cout << "Skipped Negatives Test Passed!" << std::endl;
+}
+
+// Per-pair against shared-negative GEMM training, same corpus and settings.
+void test_shared_negatives() {
+    const std::string corpus = topic_corpus(200000);
+    const std::string fruit = "apple banana cherry grape lemon mango peach plum";
+    for (bool shared : {false, true}) {
+        Word2Vec<float>* model = nullptr;
+        const double seconds = train_seconds(1, corpus, model, shared);
+        const size_t neighbours = same_topic(model->most_similar("cherry", 7), fruit);
+        assert(neighbours >= 6);
+        std::cout << (shared ? "shared negatives: " : "per pair:         ") << 4 * 200000 / seconds * 1e-6
+                  << " M words/s, final loss " << model->get_epoch_losses().back()
+                  << ", " << neighbours << "/7 same-topic neighbours" << std::endl;
+        delete model;
+    }
+}
+
+int main() {
+    test_kernel<float>();
+    test_kernel<double>();
+    std::cout << "Kernel Test Passed!" << std::endl;
+    test_hogwild();
+    test_small();
+    test_small_team();
+    test_skipped_negatives();
+    test_allocations(false);
+    test_allocations(true);
+    test_throughput();
+    test_shared_negatives();
+    std::cout << "All tests passed!" << std::endl;
+    return 0;
+}